@@ -0,0 +1,202 @@
+/*Aho-Corasick*/
+//Matches many patterns in one pass over the text (cf. kmp.cpp, which
+//matches one pattern per pass)
+
+//Bytes that occur in no pattern share class 0 and every other byte
+//gets its own class, so rows are only as wide as the patterns'
+//alphabet. If states*classes fits in denseBudget bytes, every state
+//gets a full row (one lookup per text byte). Otherwise states keep
+//only their trie edges, sorted, plus a failure link, and the root row
+//alone is dense.
+//Matches are reported as (pattern id, offset of the match's first
+//byte); pattern ids are indices into the constructor's vector.
+//Empty patterns never match.
+class AhoCorasick{
+
+public:
+  struct Match{
+    uint32_t pattern;
+    uint64_t offset;
+  };
+
+  //where a scan left off; feed a long text through one of these in
+  //chunks of any size and matches spanning chunks are still found
+  struct Cursor{
+    int state;
+    uint64_t offset;
+    Cursor() : state(0), offset(0) {}
+  };
+
+private:
+  //up to 257 classes (class 0 plus one per byte), hence 16 bits
+  uint16_t cls[256];
+  int classes, states;
+  bool dense;
+
+  //dense mode: delta[s*classes + c]
+  vector<int32_t> delta;
+
+  //sparse mode: trie edges of s are label/child[first[s]..first[s+1])
+  vector<uint32_t> first;
+  vector<uint16_t> label;
+  vector<int32_t> child, fail;
+
+  //ids of the patterns ending exactly at s are ids[outFirst[s]..outFirst[s+1])
+  //dictLink[s] = nearest state on s's failure chain with outputs, or -1
+  vector<uint32_t> outFirst, ids;
+  vector<int32_t> dictLink;
+  vector<uint32_t> patLen;
+  size_t mostOut;
+
+  int stepSparse(int s, int c) const {
+    while(s){
+      for(uint32_t e = first[s]; e < first[s+1]; e++){
+	if (label[e] == c) { return child[e]; }
+	if (label[e] > c) { break; }
+      }
+      s = fail[s];
+    }
+    return delta[c];
+  }
+
+public:
+  AhoCorasick(const vector<string>& patterns,
+	      size_t denseBudget = 64 << 20) : mostOut(0) {
+    //byte classes
+    memset(cls, 0, sizeof cls);
+    classes = 1;
+    for(auto& p: patterns){
+      for(unsigned char ch: p){
+	if (!cls[ch]) { cls[ch] = classes++; }
+      }
+    }
+
+    //trie, with each node's children as (class, node) pairs
+    vector<vector<pair<int,int> > > kids(1);
+    vector<vector<uint32_t> > ends(1);
+    for(size_t id = 0; id < patterns.size(); id++){
+      patLen.push_back(patterns[id].size());
+      if (patterns[id].empty()) { continue; }
+
+      int s = 0;
+      for(unsigned char ch: patterns[id]){
+	int c = cls[ch], next = -1;
+	for(auto& k: kids[s]){
+	  if (k.first == c) { next = k.second; break; }
+	}
+	if (next < 0) {
+	  next = kids.size();
+	  kids[s].push_back({c,next});
+	  kids.emplace_back();
+	  ends.emplace_back();
+	}
+	s = next;
+      }
+      ends[s].push_back(id);
+    }
+    states = kids.size();
+    dense = (size_t)states * classes * sizeof(int32_t) <= denseBudget;
+
+    for(auto& k: kids) { sort(k.begin(), k.end()); }
+    if (!dense) {
+      first.assign(states+1, 0);
+      for(int s = 0; s < states; s++){
+	first[s+1] = first[s] + kids[s].size();
+	for(auto& k: kids[s]){
+	  label.push_back(k.first);
+	  child.push_back(k.second);
+	}
+      }
+    }
+
+    //failure links in BFS order; in dense mode each row starts as a
+    //copy of its failure state's row, then the trie edges overwrite it
+    fail.assign(states, 0);
+    dictLink.assign(states, -1);
+    delta.assign(dense ? (size_t)states*classes : classes, 0);
+    for(auto& k: kids[0]) { delta[k.first] = k.second; }
+
+    vi order(1,0);
+    for(size_t i = 0; i < order.size(); i++){
+      int s = order[i];
+      for(auto& k: kids[s]){
+	int c = k.first, t = k.second;
+	if (s) { fail[t] = dense ? delta[(size_t)fail[s]*classes + c]
+	    : stepSparse(fail[s], c); }
+	dictLink[t] = ends[fail[t]].empty() ? dictLink[fail[t]] : fail[t];
+	order.push_back(t);
+      }
+      if (dense && s) {
+	copy(delta.begin() + (size_t)fail[s]*classes,
+	     delta.begin() + (size_t)fail[s]*classes + classes,
+	     delta.begin() + (size_t)s*classes);
+	for(auto& k: kids[s]) { delta[(size_t)s*classes + k.first] = k.second; }
+      }
+    }
+
+    //flatten outputs; count the longest chain of matches per byte
+    outFirst.assign(states+1, 0);
+    for(int s = 0; s < states; s++){
+      outFirst[s+1] = outFirst[s] + ends[s].size();
+      ids.insert(ids.end(), ends[s].begin(), ends[s].end());
+    }
+    vector<size_t> chain(states, 0);
+    for(int s: order){
+      chain[s] = ends[s].size() + (dictLink[s] < 0 ? 0 : chain[dictLink[s]]);
+      mostOut = max(mostOut, chain[s]);
+    }
+    if (dense) { fail = vector<int32_t>(); }
+  }
+
+  int numStates() const { return states; }
+  bool isDense() const { return dense; }
+
+  //most matches a single text byte can produce; feed() needs room for
+  //at least this many
+  size_t maxMatchesPerByte() const { return mostOut; }
+
+  //Scans text from cur, writing up to cap matches into out, ordered by
+  //end position. Stops early rather than overflow out: consumed says
+  //how many bytes were scanned, so call again with the rest once out
+  //has been drained. cap must be at least maxMatchesPerByte().
+  //returns the number of matches written
+  size_t feed(string_view text, Cursor& cur, Match* out, size_t cap,
+	      size_t& consumed) const {
+    size_t written = 0;
+    int s = cur.state;
+    size_t i = 0;
+
+    for(; i < text.size() && cap - written >= mostOut; i++){
+      int c = cls[(unsigned char)text[i]];
+      s = dense ? delta[(size_t)s*classes + c] : stepSparse(s,c);
+
+      int t = outFirst[s] != outFirst[s+1] ? s : dictLink[s];
+      for(; t >= 0; t = dictLink[t]){
+	for(uint32_t k = outFirst[t]; k < outFirst[t+1]; k++){
+	  uint32_t id = ids[k];
+	  out[written++] = {id, cur.offset + i + 1 - patLen[id]};
+	}
+      }
+    }
+
+    cur.state = s;
+    cur.offset += i;
+    consumed = i;
+    return written;
+  }
+
+  //every match in text, ordered by end position
+  size_t findAll(string_view text, vector<Match>& matches) const {
+    Cursor cur;
+    size_t cap = max<size_t>(mostOut, 4096);
+    vector<Match> buf(cap);
+    while(!text.empty()){
+      size_t used;
+      size_t got = feed(text, cur, buf.data(), cap, used);
+      matches.insert(matches.end(), buf.begin(), buf.begin()+got);
+      text.remove_prefix(used);
+    }
+    return matches.size();
+  }
+
+};
@@ -0,0 +1,183 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#define vi vector<int>
+
+#include "parallel.cpp"
+#include "kmp.cpp"
+#include "ahoCorasick.cpp"
+
+//Checks AhoCorasick against brute force, then times it against
+//repeated KMP (one KmpDFA::search per pattern) on the same text.
+//usage: ahoCorasickTest [textMB patterns patternLength]
+
+//every (pattern, offset) pair, ordered like AhoCorasick's output: by
+//end position, then longest pattern (i.e. the dictionary-link chain) first
+vector<pair<uint32_t,uint64_t> > bruteForce(const vector<string>& patterns,
+					    string_view text){
+  vector<pair<uint64_t, pair<size_t,uint32_t> > > found;
+  for(uint32_t id = 0; id < patterns.size(); id++){
+    size_t len = patterns[id].size();
+    if (len == 0) { continue; }
+    for(size_t i = 0; i + len <= text.size(); i++){
+      if (text.compare(i, len, patterns[id]) == 0) {
+	found.push_back({i+len, {SIZE_MAX-len, id}});
+      }
+    }
+  }
+  sort(found.begin(), found.end());
+
+  vector<pair<uint32_t,uint64_t> > ret;
+  for(auto& f: found){
+    ret.push_back({f.second.second, f.first - (SIZE_MAX - f.second.first)});
+  }
+  return ret;
+}
+
+//findAll, and a feed() through chunks of random size, both sorted the
+//same way as bruteForce
+bool agrees(const AhoCorasick& ac, const vector<string>& patterns,
+	    string_view text, mt19937& rng){
+  auto expected = bruteForce(patterns, text);
+  auto canonical = [&](const vector<AhoCorasick::Match>& ms){
+    vector<pair<uint64_t, pair<size_t,uint32_t> > > v;
+    for(auto& m: ms){
+      size_t len = patterns[m.pattern].size();
+      v.push_back({m.offset+len, {SIZE_MAX-len, m.pattern}});
+    }
+    sort(v.begin(), v.end());
+    vector<pair<uint32_t,uint64_t> > ret;
+    for(auto& x: v){
+      ret.push_back({x.second.second, x.first - (SIZE_MAX - x.second.first)});
+    }
+    return ret;
+  };
+
+  vector<AhoCorasick::Match> all;
+  ac.findAll(text, all);
+  if (canonical(all) != expected) { return false; }
+
+  vector<AhoCorasick::Match> streamed;
+  size_t cap = ac.maxMatchesPerByte() + rng()%4;
+  vector<AhoCorasick::Match> buf(max<size_t>(cap,1));
+  AhoCorasick::Cursor cur;
+  string_view rest = text;
+  while(!rest.empty()){
+    string_view chunk = rest.substr(0, 1 + rng()%8);
+    while(!chunk.empty()){
+      size_t used;
+      size_t got = ac.feed(chunk, cur, buf.data(), cap, used);
+      streamed.insert(streamed.end(), buf.begin(), buf.begin()+got);
+      chunk.remove_prefix(used);
+      rest.remove_prefix(used);
+    }
+  }
+  return canonical(streamed) == expected;
+}
+
+int check(){
+  mt19937 rng(20);
+  int failures = 0;
+
+  //random patterns over small alphabets, in both dense and sparse mode
+  for(int it = 0; it < 3000; it++){
+    int sigma = 1 + rng()%4;
+    vector<string> patterns(rng()%12);
+    for(auto& p: patterns){
+      p.resize(rng()%6);
+      for(auto& ch: p) { ch = 'a' + rng()%sigma; }
+    }
+    string text(rng()%200, 0);
+    for(auto& ch: text) { ch = 'a' + rng()%(sigma+1); }
+
+    for(size_t budget: {(size_t)64 << 20, (size_t)0}){
+      AhoCorasick ac(patterns, budget);
+      if (!agrees(ac, patterns, text, rng)) {
+	printf("random patterns: it=%d dense=%d\n", it, ac.isDense());
+	failures++;
+      }
+    }
+  }
+
+  //every byte value in some pattern: 257 byte classes
+  vector<string> bytes;
+  for(int c = 0; c < 256; c++) { bytes.push_back(string(1, (char)c)); }
+  bytes.push_back("\xff\xff");
+  string zeros(2, '\0');
+  for(size_t budget: {(size_t)64 << 20, (size_t)0}){
+    AhoCorasick ac(bytes, budget);
+    vector<AhoCorasick::Match> ms;
+    if (ac.findAll(zeros, ms) != 2 || !agrees(ac, bytes, zeros, rng)) {
+      printf("all 256 bytes: dense=%d, %zu matches\n", ac.isDense(), ms.size());
+      failures++;
+    }
+    string text(300, 0);
+    for(auto& ch: text) { ch = rng(); }
+    if (!agrees(ac, bytes, text, rng)) {
+      printf("all 256 bytes, random text: dense=%d\n", ac.isDense());
+      failures++;
+    }
+  }
+
+  return failures;
+}
+
+void benchmark(size_t textBytes, int count, int length){
+  mt19937 rng(1);
+  //text over 16 letters, so that patterns of length 8 match now and then
+  string text(textBytes, 0);
+  for(auto& ch: text) { ch = 'a' + rng()%16; }
+  vector<string> patterns(count);
+  for(auto& p: patterns){
+    size_t at = rng()%(textBytes - length);
+    p = rng()%2 ? text.substr(at, length) : string(length, 'a' + rng()%16);
+  }
+
+  auto start = chrono::steady_clock::now();
+  AhoCorasick ac(patterns);
+  vector<AhoCorasick::Match> matches;
+  ac.findAll(text, matches);
+  chrono::duration<double> t = chrono::steady_clock::now() - start;
+  printf("aho-corasick (%s, %d states): %zu matches in %.3fs\n",
+	 ac.isDense() ? "dense" : "sparse", ac.numStates(), matches.size(),
+	 t.count());
+
+  start = chrono::steady_clock::now();
+  size_t found = 0;
+  for(auto& p: patterns){
+    vector<uint64_t> occurrences;
+    found += KmpDFA(p).search(text, occurrences);
+  }
+  t = chrono::steady_clock::now() - start;
+  printf("repeated kmp (%d passes): %zu matches in %.3fs\n",
+	 count, found, t.count());
+}
+
+int main(int argc, char** argv){
+  int failures = check();
+  printf("check: %s\n", failures ? "FAILED" : "ok");
+
+  size_t textMB = 16;
+  int count = 200, length = 8;
+  if (argc == 4) {
+    textMB = atoi(argv[1]);
+    count = atoi(argv[2]);
+    length = atoi(argv[3]);
+  }
+  benchmark(textMB << 20, count, length);
+
+  return failures ? 1 : 0;
+}
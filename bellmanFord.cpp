@@ -1,18 +1,18 @@
-
 //|adj| = n
-bool bellmanFord(int n, AdjacencyList& adj, int root, vi& node2root){
-  vector<int> dist;
-  vector<int> parent;
-  for (auto u: adj){
-    dist.push_back(INT_MAX);
-    parent.push_back(-1);
-  }
+//Graph is an AdjacencyList or a CSRGraph
+template <typename Graph>
+bool bellmanFord(int n, Graph& adj, int root, vi& node2root){
+  vector<int> dist(n, INT_MAX);
+  vector<int> parent(n, -1);
 
   dist[root] = 0;
   node2root[root] = root;
 
   for(int i = 1; i <= n-1; i++){
+    bool changed = false;
     for(int u = 0; u < n; u++){
+      //unreached, and INT_MAX + d would overflow
+      if (dist[u] == INT_MAX) { continue; }
       for(auto p: adj[u]){
 	int v = p.first;
 	int d = p.second;
@@ -20,31 +20,125 @@ bool bellmanFord(int n, AdjacencyList& adj, int root, vi& node2root){
 	  dist[v] = dist[u] + d;
 	  parent[v] = u;
 	  node2root[v] = root;
+	  changed = true;
 	}
       }
     }
+    //converged early
+    if (!changed) { return false; }
   }
 
   for(int u = 0; u < n; u++){
+    if (dist[u] == INT_MAX) { continue; }
     for(auto p: adj[u]){
       int v = p.first;
       int d = p.second;
       if (dist[v] > dist[u] + d) { return true; }
     }
-  }  
+  }
 
   return false;
 }
 
-bool hasNegativeCycle(int n, AdjacencyList& adj) {
-  //map node to the root of the search tree
-  vi node2root;
-  for (auto u: adj){ node2root.push_back(-1); }
+//finds a cycle in the shortest-path tree (parent pointers), if any
+//any such cycle has negative weight
+bool parentCycle(vi& parent, vi& cycle){
+  int n = parent.size();
+  //0 = unseen, 1 = on the current walk, 2 = finished
+  vector<char> state(n,0);
 
-  for(int u = 0; u < n; u++){
-    if (node2root[u] == -1 && bellmanFord(n,adj,u,node2root))
-      { return true; }
+  for(int s = 0; s < n; s++){
+    int u = s;
+    while(u != -1 && state[u] == 0){
+      state[u] = 1;
+      u = parent[u];
+    }
+
+    //walked back into this walk: u is on a cycle
+    if (u != -1 && state[u] == 1) {
+      int v = u;
+      do {
+	cycle.push_back(v);
+	v = parent[v];
+      } while(v != u);
+      reverse(cycle.begin(), cycle.end());
+      return true;
+    }
+
+    for(u = s; u != -1 && state[u] == 1; u = parent[u]) { state[u] = 2; }
   }
 
   return false;
 }
+
+//Queue-based Bellman-Ford (SPFA)
+//only edges out of nodes whose distance just dropped are relaxed,
+//and it stops as soon as no distance changes
+//root = -1 starts from a virtual super-source with a 0-weight edge to
+//every node, so one run finds a negative cycle anywhere in the graph
+//dist[v] = LLONG_MAX if v is unreachable
+//returns true if there is a negative cycle, and fills cycle with it
+//(in edge order); dist is meaningless in that case
+template <typename Graph>
+bool spfa(Graph& adj, int root, vector<ll>& dist, vi& cycle){
+  int n = adj.size();
+  dist.assign(n, LLONG_MAX);
+  vi parent(n,-1);
+
+  //each node is queued at most once at a time, so a ring of n suffices
+  vi q(n);
+  vector<char> queued(n,0);
+  size_t head = 0, count = 0;
+  auto push = [&](int v){
+    if (queued[v]) { return; }
+    queued[v] = 1;
+    q[(head+count)%n] = v;
+    count++;
+  };
+
+  if (root < 0) {
+    for(int v = 0; v < n; v++) { dist[v] = 0; push(v); }
+  }
+  else {
+    dist[root] = 0;
+    push(root);
+  }
+
+  //look for a cycle among the parent pointers every n relaxations;
+  //with a negative cycle one eventually appears, without one the queue drains
+  long long relaxations = 0;
+
+  while(count){
+    int u = q[head];
+    head = (head+1)%n;
+    count--;
+    queued[u] = 0;
+
+    for(auto p: adj[u]){
+      int v = p.first;
+      ll d = dist[u] + p.second;
+      if (d < dist[v]) {
+	dist[v] = d;
+	parent[v] = u;
+	push(v);
+
+	if (++relaxations % n == 0 && parentCycle(parent, cycle))
+	  { return true; }
+      }
+    }
+  }
+
+  return false;
+}
+
+template <typename Graph>
+bool hasNegativeCycle(Graph& adj) {
+  vector<ll> dist;
+  vi cycle;
+  return spfa(adj, -1, dist, cycle);
+}
+
+//old signature, kept for existing callers; n is the graph's size
+bool hasNegativeCycle(int /*n*/, AdjacencyList& adj) {
+  return hasNegativeCycle(adj);
+}
@@ -3,11 +3,31 @@
 #include <set>
 #include <algorithm>
 #include <iostream>
+#include <climits>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <new>
 
 //binary heap with change key
+//Include-only: files that build with it #include "binaryHeap.cpp"
+#pragma once
 
 using namespace std;
 
+#include "parallel.cpp"
+
+#ifndef vi
+#define vi vector<int>
+#endif
+//distance of an unreached node; the macro tells later fragments INF exists
+#ifndef INF
+const int INF = 1e9;
+#define INF INF
+#endif
+
 template <typename T>
 class MinHeap{
 private:
@@ -160,26 +180,491 @@ public:
 };
 
 
+//binary heap over dense handles 0..n-1, each with its own key
+//pos[id] is where id sits in h, so changeKey needs no search or allocation
+//keys may repeat; ties are broken arbitrarily
+template <typename T>
+class IndexedMinHeap{
+private:
+  static constexpr size_t NONE = (size_t)-1;
+
+  // handles in heap order (1-based, like MinHeap)
+  vector<size_t> h;
+  // key and heap position of each handle
+  vector<T> key;
+  vector<size_t> pos;
+
+  void place(size_t i, size_t id){
+    h[i] = id;
+    pos[id] = i;
+  }
+
+  void pushDown(size_t i){
+    size_t id = h[i];
+    size_t n = h.size();
+    while (2*i < n) {
+      size_t child = 2*i;
+      if (child+1 < n && key[h[child+1]] < key[h[child]]) { child++; }
+      if (!(key[h[child]] < key[id])) { break; }
+      place(i, h[child]);
+      i = child;
+    }
+    place(i, id);
+  }
+
+  void bubbleUp(size_t i){
+    size_t id = h[i];
+    while (i != 1 && key[id] < key[h[i/2]]) {
+      place(i, h[i/2]);
+      i /= 2;
+    }
+    place(i, id);
+  }
+
+public:
+  IndexedMinHeap(size_t n = 0) : h(1), key(n), pos(n, NONE) {
+    h.reserve(n+1);
+  }
+
+  void reserve(size_t n){
+    key.resize(n);
+    pos.resize(n, NONE);
+    h.reserve(n+1);
+  }
+
+  bool contains(size_t id) const { return pos[id] != NONE; }
+
+  const T& keyOf(size_t id) const { return key[id]; }
+
+  void insert(size_t id, T k){
+    key[id] = k;
+    h.push_back(id);
+    bubbleUp(h.size()-1);
+  }
+
+  size_t peekMin() const { return h[1]; }
+
+  size_t extractMin(){
+    size_t ret = h[1];
+    pos[ret] = NONE;
+
+    size_t last = h.back();
+    h.pop_back();
+    if (h.size() > 1) {
+      h[1] = last;
+      pushDown(1);
+    }
+
+    return ret;
+  }
+
+  void changeKey(size_t id, T newKey){
+    if (!contains(id)) { return; }
+
+    T oldKey = key[id];
+    key[id] = newKey;
+    if (oldKey < newKey) { pushDown(pos[id]); }
+    else { bubbleUp(pos[id]); }
+  }
+
+  void decreaseKey(size_t id, T newKey){
+    key[id] = newKey;
+    bubbleUp(pos[id]);
+  }
+
+  size_t size() const { return h.size()-1; }
+
+  bool empty() const { return h.size() == 1; }
+
+  void clear(){
+    for(size_t i = 1; i < h.size(); i++) { pos[h[i]] = NONE; }
+    h.resize(1);
+  }
+
+};
+
+
+//The heaps below share IndexedMinHeap's interface, so dijkstra can take
+//any of them as its Heap template parameter
+
+//allocator handing out Align-byte aligned blocks
+template <typename T, size_t Align>
+struct AlignedAllocator{
+  typedef T value_type;
+  template <typename U> struct rebind { typedef AlignedAllocator<U,Align> other; };
+
+  AlignedAllocator() {}
+  template <typename U> AlignedAllocator(const AlignedAllocator<U,Align>&) {}
+
+  T* allocate(size_t n){
+    return (T*) ::operator new(n*sizeof(T), align_val_t(Align));
+  }
+  void deallocate(T* p, size_t){ ::operator delete(p, align_val_t(Align)); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U,Align>&) const { return true; }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U,Align>&) const { return false; }
+};
+
+//D-ary heap over dense handles
+//(key, handle) pairs sit inline in the heap array, so the D children
+//compared in pushDown are one contiguous run instead of D lookups into key
+//The root sits at index D-1 (the slots before it are padding), so every
+//sibling group starts at a multiple of D; with 16-byte entries, D = 4
+//and a 64-byte aligned array, each group is exactly one cache line
+template <typename T, int D = 4>
+class DaryHeap{
+private:
+  static constexpr size_t NONE = (size_t)-1;
+  static constexpr size_t ROOT = D-1;
+
+  struct Entry{
+    T key;
+    size_t id;
+  };
+
+  //children of i are D*(i-ROOT+1) .. D*(i-ROOT+1)+D-1
+  vector<Entry, AlignedAllocator<Entry,64> > h;
+  vector<size_t> pos;
+
+  static size_t firstChild(size_t i) { return D*(i-ROOT+1); }
+  static size_t parent(size_t i) { return i/D + ROOT-1; }
+
+  void place(size_t i, const Entry& e){
+    h[i] = e;
+    pos[e.id] = i;
+  }
+
+  void pushDown(size_t i){
+    Entry e = h[i];
+    size_t n = h.size();
+    while (firstChild(i) < n) {
+      size_t first = firstChild(i);
+      size_t last = min(first+D, n);
+      size_t child = first;
+      for(size_t c = first+1; c < last; c++){
+	if (h[c].key < h[child].key) { child = c; }
+      }
+      if (!(h[child].key < e.key)) { break; }
+      place(i, h[child]);
+      i = child;
+    }
+    place(i, e);
+  }
+
+  void bubbleUp(size_t i){
+    Entry e = h[i];
+    while (i != ROOT && e.key < h[parent(i)].key) {
+      place(i, h[parent(i)]);
+      i = parent(i);
+    }
+    place(i, e);
+  }
+
+public:
+  DaryHeap(size_t n = 0) : h(ROOT), pos(n, NONE) { h.reserve(n+ROOT); }
+
+  bool contains(size_t id) const { return pos[id] != NONE; }
+
+  const T& keyOf(size_t id) const { return h[pos[id]].key; }
+
+  void insert(size_t id, T k){
+    h.push_back({k,id});
+    bubbleUp(h.size()-1);
+  }
+
+  size_t peekMin() const { return h[ROOT].id; }
+
+  size_t extractMin(){
+    size_t ret = h[ROOT].id;
+    pos[ret] = NONE;
+
+    Entry last = h.back();
+    h.pop_back();
+    if (h.size() > ROOT) {
+      h[ROOT] = last;
+      pushDown(ROOT);
+    }
+
+    return ret;
+  }
+
+  void changeKey(size_t id, T newKey){
+    if (!contains(id)) { return; }
+
+    size_t i = pos[id];
+    T oldKey = h[i].key;
+    h[i].key = newKey;
+    if (oldKey < newKey) { pushDown(i); }
+    else { bubbleUp(i); }
+  }
+
+  void decreaseKey(size_t id, T newKey){
+    h[pos[id]].key = newKey;
+    bubbleUp(pos[id]);
+  }
+
+  size_t size() const { return h.size() - ROOT; }
+
+  bool empty() const { return h.size() == ROOT; }
+
+};
+
+//Monotone radix heap for non-negative integer keys
+//keys must never be below the last extracted or peeked key (true in
+//dijkstra)
+//bucket b holds keys whose highest bit differing from that last key is
+//bit b-1, so each key moves down at most once per bit
+//decreaseKey reinserts and stale copies are dropped when met
+template <typename T>
+class RadixHeap{
+private:
+  static const int BITS = 8*sizeof(unsigned long long);
+
+  struct Entry{
+    unsigned long long key;
+    size_t id;
+  };
+
+  //peekMin redistributes too, hence mutable
+  mutable vector<Entry> buckets[BITS+1];
+  vector<unsigned long long> key;
+  vector<char> in;
+  mutable unsigned long long last;
+  size_t live;
+
+  int bucketOf(unsigned long long k) const {
+    return k == last ? 0 : BITS - __builtin_clzll(k ^ last);
+  }
+
+  bool stale(const Entry& e) const { return !in[e.id] || key[e.id] != e.key; }
+
+  void push(size_t id, unsigned long long k){
+    buckets[bucketOf(k)].push_back({k,id});
+  }
+
+  //move the smallest key into bucket 0
+  void pull() const {
+    while(true){
+      while(!buckets[0].empty() && stale(buckets[0].back()))
+	{ buckets[0].pop_back(); }
+      if (!buckets[0].empty()) { return; }
+
+      int b = 1;
+      while(buckets[b].empty()) { b++; }
+
+      unsigned long long m = ULLONG_MAX;
+      for(auto& e: buckets[b]){
+	if (!stale(e)) { m = min(m, e.key); }
+      }
+      //only stale copies here
+      if (m == ULLONG_MAX) {
+	buckets[b].clear();
+	continue;
+      }
+
+      last = m;
+      for(auto& e: buckets[b]){
+	if (!stale(e)) { buckets[bucketOf(e.key)].push_back(e); }
+      }
+      buckets[b].clear();
+    }
+  }
+
+public:
+  RadixHeap(size_t n = 0) : key(n), in(n,0), last(0), live(0) {}
+
+  bool contains(size_t id) const { return in[id]; }
+
+  T keyOf(size_t id) const { return key[id]; }
+
+  void insert(size_t id, T k){
+    key[id] = k;
+    in[id] = 1;
+    live++;
+    push(id,k);
+  }
+
+  size_t peekMin() const {
+    pull();
+    return buckets[0].back().id;
+  }
+
+  size_t extractMin(){
+    pull();
+    size_t ret = buckets[0].back().id;
+    buckets[0].pop_back();
+    in[ret] = 0;
+    live--;
+    return ret;
+  }
+
+  void decreaseKey(size_t id, T newKey){
+    key[id] = newKey;
+    push(id,newKey);
+  }
+
+  void changeKey(size_t id, T newKey){
+    if (contains(id)) { decreaseKey(id,newKey); }
+  }
+
+  size_t size() const { return live; }
+
+  bool empty() const { return live == 0; }
+
+};
+
+//Pairing heap over dense handles: decreaseKey is O(1) (amortized
+//O(log n) at worst) since it only cuts the node's subtree and links it
+//back at the root
+//nodes live in flat arrays indexed by handle, so nothing is allocated
+template <typename T>
+class PairingHeap{
+private:
+  static constexpr int NIL = -1;
+
+  vector<T> key;
+  //prev is the parent for a first child, else the left sibling
+  vi child, next, prev;
+  vector<char> in;
+  int root;
+  size_t count;
+
+  //makes the larger root a child of the smaller; returns the new root
+  int meld(int a, int b){
+    if (a == NIL) { return b; }
+    if (b == NIL) { return a; }
+    if (key[b] < key[a]) { swap(a,b); }
+
+    next[b] = child[a];
+    if (child[a] != NIL) { prev[child[a]] = b; }
+    prev[b] = a;
+    child[a] = b;
+    next[a] = prev[a] = NIL;
+    return a;
+  }
+
+  void cut(int x){
+    if (prev[x] == NIL) { return; }
+    if (child[prev[x]] == x) { child[prev[x]] = next[x]; }
+    else { next[prev[x]] = next[x]; }
+    if (next[x] != NIL) { prev[next[x]] = prev[x]; }
+    next[x] = prev[x] = NIL;
+  }
+
+  //two-pass pairing of the sibling list starting at first
+  int mergePairs(int first){
+    if (first == NIL) { return NIL; }
+
+    //left to right: meld pairs, chaining the results through prev
+    int paired = NIL;
+    while(first != NIL){
+      int a = first;
+      int b = next[a];
+      first = (b == NIL) ? NIL : next[b];
+      next[a] = prev[a] = NIL;
+      if (b != NIL) { next[b] = prev[b] = NIL; }
+      int m = meld(a,b);
+      prev[m] = paired;
+      paired = m;
+    }
+
+    //right to left: meld everything into one tree
+    int ans = NIL;
+    while(paired != NIL){
+      int below = prev[paired];
+      prev[paired] = NIL;
+      ans = meld(ans, paired);
+      paired = below;
+    }
+    return ans;
+  }
+
+public:
+  PairingHeap(size_t n = 0)
+    : key(n), child(n,NIL), next(n,NIL), prev(n,NIL), in(n,0),
+      root(NIL), count(0) {}
+
+  bool contains(size_t id) const { return in[id]; }
+
+  const T& keyOf(size_t id) const { return key[id]; }
+
+  void insert(size_t id, T k){
+    key[id] = k;
+    child[id] = next[id] = prev[id] = NIL;
+    in[id] = 1;
+    count++;
+    root = meld(root, id);
+  }
+
+  size_t peekMin() const { return root; }
+
+  size_t extractMin(){
+    int ret = root;
+    root = mergePairs(child[ret]);
+    child[ret] = NIL;
+    in[ret] = 0;
+    count--;
+    return ret;
+  }
+
+  void decreaseKey(size_t id, T newKey){
+    key[id] = newKey;
+    if ((int)id == root) { return; }
+    cut(id);
+    root = meld(root, id);
+  }
+
+  //raising a key: pull the node out and push it back in
+  void changeKey(size_t id, T newKey){
+    if (!contains(id)) { return; }
+    if (!(key[id] < newKey)) { decreaseKey(id,newKey); return; }
+
+    if ((int)id == root) { extractMin(); }
+    else {
+      cut(id);
+      int kids = mergePairs(child[id]);
+      child[id] = NIL;
+      root = meld(root, kids);
+      in[id] = 0;
+      count--;
+    }
+    insert(id,newKey);
+  }
+
+  size_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+};
+
+
 //at end of function, map nodes to shortest-path distance from root
-//uses MinHeap to dynamically change weights in priority queue
-void dijkstra(AdjacencyList& adj, size_t root, vi& distance){
-  MinHeap<pair<int,size_t> > pq;
-  repeat(u,0,adj.size()){
-    pq.insert({INF,u});
+//uses a heap keyed by node to dynamically change weights
+//Heap is IndexedMinHeap, DaryHeap, RadixHeap or PairingHeap (over int),
+//e.g. dijkstra<RadixHeap<int> >(adj, root, distance)
+//Graph is an AdjacencyList or a CSRGraph
+template <typename Heap = IndexedMinHeap<int>, typename Graph>
+void dijkstra(Graph& adj, size_t root, vi& distance){
+  Heap pq(adj.size());
+  for(size_t u = 0; u < adj.size(); u++){
+    pq.insert(u,INF);
     distance.push_back(INF);
   }
-  pq.changeKey({INF,root}, {0,root});
+  pq.decreaseKey(root,0);
   distance[root] = 0;
 
   while(!pq.empty()){
-    pair<int,size_t> p = pq.extractMin();
-    int d = p.first;
-    size_t u = p.second;
+    size_t u = pq.extractMin();
+    int d = distance[u];
+    //everything left is unreachable
+    if (d == INF) { break; }
     for(auto neigh: adj[u]){
       size_t v = neigh.first;
       int uv = neigh.second;
       if (d+uv < distance[v]) {
-	pq.changeKey({distance[v],v}, {d+uv,v});
+	pq.decreaseKey(v,d+uv);
 	distance[v] = d+uv;
       }
     }
@@ -187,27 +672,305 @@ void dijkstra(AdjacencyList& adj, size_t root, vi& distance){
 
 }
 
-int main(){
-  MinHeap<int> h;
-
-  h.insert(5);
-  h.print(); 
-  h.insert(10);
-  h.print(); 
-  h.insert(20);
-  h.print(); 
-  h.insert(12);
-  h.print(); 
-  h.insert(11);
-  h.print(); 
-  h.insert(2);
-  h.print(); 
-
-  h.changeKey(12,7);
-  h.print();
-  h.changeKey(2,12);
-  h.print();
-
-  h.extractMin();
-  h.print();
+//Delta-stepping: same result as dijkstra() for non-negative weights
+//Nodes sit in buckets of width delta by tentative distance. The lowest
+//bucket is emptied in rounds that relax its light edges (weight <= delta)
+//in parallel; once it stays empty, heavy edges of everything it settled
+//are relaxed in one more parallel round.
+//Small rounds run serially, since they are cheaper than starting threads
+template <typename Graph>
+void deltaStepping(Graph& adj, size_t root, vi& distance, int delta,
+		   int threads = 0){
+  const size_t PARALLEL_ROUND = 4096;
+  size_t n = adj.size();
+  threads = numThreads(threads);
+
+  vector<atomic<int> > dist(n);
+  for(auto& d: dist) { d.store(INF, memory_order_relaxed); }
+  dist[root] = 0;
+
+  vector<vi> buckets(1, vi(1,root));
+  vector<vi> improved(threads);
+  //seen[v] == round iff v is already in this round's frontier
+  vi seen(n,-1);
+  vector<char> settled(n,0);
+  int round = 0;
+
+  //lowers dist[v] to d; true if d was an improvement
+  auto relaxTo = [&](int v, int d){
+    int cur = dist[v].load(memory_order_relaxed);
+    while(d < cur){
+      if (dist[v].compare_exchange_weak(cur, d, memory_order_relaxed))
+	{ return true; }
+    }
+    return false;
+  };
+
+  //relax the light (or heavy) edges out of nodes
+  auto relax = [&](vi& nodes, bool light){
+    auto work = [&](size_t lo, size_t hi, int t){
+      for(size_t i = lo; i < hi; i++){
+	int u = nodes[i];
+	int du = dist[u].load(memory_order_relaxed);
+	for(auto neigh: adj[u]){
+	  int uv = neigh.second;
+	  if ((uv <= delta) != light) { continue; }
+	  int v = neigh.first;
+	  if (relaxTo(v, du+uv)) { improved[t].push_back(v); }
+	}
+      }
+    };
+    if (nodes.size() < PARALLEL_ROUND) { work(0, nodes.size(), 0); }
+    else { parallelBlocks(threads, nodes.size(), work); }
+
+    for(auto& list: improved){
+      for(int v: list){
+	size_t b = dist[v].load(memory_order_relaxed) / delta;
+	if (b >= buckets.size()) { buckets.resize(b+1); }
+	buckets[b].push_back(v);
+      }
+      list.clear();
+    }
+  };
+
+  for(size_t i = 0; i < buckets.size(); i++){
+    vi done;
+
+    while(!buckets[i].empty()){
+      vi frontier;
+      for(int v: buckets[i]){
+	//stale entry: v has since moved to a lower bucket
+	if ((size_t)dist[v].load(memory_order_relaxed) / delta != i) { continue; }
+	if (seen[v] == round) { continue; }
+	seen[v] = round;
+	frontier.push_back(v);
+	if (!settled[v]) {
+	  settled[v] = 1;
+	  done.push_back(v);
+	}
+      }
+      buckets[i].clear();
+      round++;
+
+      relax(frontier, true);
+    }
+
+    relax(done, false);
+    //free the bucket; i never comes back
+    vi().swap(buckets[i]);
+  }
+
+  distance.resize(n);
+  for(size_t v = 0; v < n; v++) { distance[v] = dist[v]; }
+}
+
+//Buffers for point-to-point queries, reused from query to query
+//Nodes enter the heaps only when first reached, and only the touched
+//entries are reset afterwards, so a query costs O(explored region)
+//side 0 searches forwards from the source, side 1 backwards from the target
+struct PathScratch{
+  IndexedMinHeap<int> pq[2];
+  vi dist[2];
+  vi touched[2];
+
+  void prepare(size_t n){
+    for(int side = 0; side < 2; side++){
+      if (dist[side].size() < n) {
+	dist[side].resize(n, INF);
+	pq[side].reserve(n);
+      }
+    }
+  }
+
+  void reset(){
+    for(int side = 0; side < 2; side++){
+      for(int v: touched[side]) { dist[side][v] = INF; }
+      touched[side].clear();
+      pq[side].clear();
+    }
+  }
+
+  //offers distance d to v on one side; true if it improved
+  bool reach(int side, int v, int d){
+    int& cur = dist[side][v];
+    if (d >= cur) { return false; }
+
+    if (cur == INF) {
+      touched[side].push_back(v);
+      pq[side].insert(v,d);
+    }
+    else { pq[side].decreaseKey(v,d); }
+    cur = d;
+    return true;
+  }
+};
+
+//length of the shortest path from source to target (INF if none)
+//stops as soon as target is settled
+template <typename Graph>
+int shortestPath(Graph& adj, int source, int target, PathScratch& s){
+  s.prepare(adj.size());
+  s.reach(0, source, 0);
+
+  int ans = INF;
+  while(!s.pq[0].empty()){
+    int u = s.pq[0].extractMin();
+    int d = s.dist[0][u];
+    if (u == target) { ans = d; break; }
+
+    for(auto neigh: adj[u]) { s.reach(0, neigh.first, d+neigh.second); }
+  }
+
+  s.reset();
+  return ans;
+}
+
+//same, with buffers kept per thread between calls
+template <typename Graph>
+int shortestPath(Graph& adj, int source, int target){
+  static thread_local PathScratch s;
+  return shortestPath(adj, source, target, s);
+}
+
+//Bidirectional Dijkstra: radj is adj with every edge reversed
+//(pass adj twice for an undirected graph)
+//grows the side with the smaller frontier key, and stops once the two
+//frontier keys add up to at least the best path seen through a meeting edge
+template <typename Graph>
+int shortestPathBidir(Graph& adj, Graph& radj, int source, int target,
+		      PathScratch& s){
+  s.prepare(adj.size());
+  s.reach(0, source, 0);
+  s.reach(1, target, 0);
+
+  int best = (source == target) ? 0 : INF;
+  while(!s.pq[0].empty() && !s.pq[1].empty()){
+    int top0 = s.pq[0].keyOf(s.pq[0].peekMin());
+    int top1 = s.pq[1].keyOf(s.pq[1].peekMin());
+    if ((long long)top0 + top1 >= best) { break; }
+
+    int side = (top0 <= top1) ? 0 : 1;
+    Graph& g = side ? radj : adj;
+    int u = s.pq[side].extractMin();
+    int d = s.dist[side][u];
+
+    for(auto neigh: g[u]){
+      int v = neigh.first;
+      s.reach(side, v, d+neigh.second);
+      int other = s.dist[1-side][v];
+      if (other != INF) { best = min(best, d+neigh.second+other); }
+    }
+  }
+
+  s.reset();
+  return best;
+}
+
+template <typename Graph>
+int shortestPathBidir(Graph& adj, Graph& radj, int source, int target){
+  static thread_local PathScratch s;
+  return shortestPathBidir(adj, radj, source, target, s);
 }
+
+//Many shortest-path queries against one graph
+//Each pool thread owns a workspace whose distances carry a generation
+//stamp: an entry only counts if its stamp is the current query's, so
+//starting a query is O(1) instead of an O(n) reset
+//Graph is an AdjacencyList, a CSRGraph or a MappedCSRGraph; the engine
+//keeps a reference, so the graph must outlive it
+template <typename Graph>
+class ShortestPathEngine{
+private:
+  struct Workspace{
+    vi dist;
+    vector<unsigned> stamp;
+    unsigned gen;
+    IndexedMinHeap<int> pq;
+
+    Workspace(size_t n) : dist(n), stamp(n,0), gen(0), pq(n) {}
+
+    void start(){
+      //stamps wrapped around; old ones could look current
+      if (++gen == 0) {
+	fill(stamp.begin(), stamp.end(), 0);
+	gen = 1;
+      }
+      pq.clear();
+    }
+
+    int get(int v) const { return stamp[v] == gen ? dist[v] : INF; }
+
+    void reach(int v, int d){
+      if (stamp[v] != gen) {
+	stamp[v] = gen;
+	dist[v] = d;
+	pq.insert(v,d);
+      }
+      else if (d < dist[v]) {
+	dist[v] = d;
+	pq.decreaseKey(v,d);
+      }
+    }
+  };
+
+  const Graph& adj;
+  ThreadPool pool;
+  vector<Workspace> ws;
+
+  //Dijkstra from source in w; stops early once target is settled
+  int run(Workspace& w, int source, int target = -1){
+    w.start();
+    w.reach(source,0);
+    while(!w.pq.empty()){
+      int u = w.pq.extractMin();
+      int d = w.dist[u];
+      if (u == target) { return d; }
+      for(auto neigh: adj[u]) { w.reach(neigh.first, d+neigh.second); }
+    }
+    return target < 0 ? 0 : INF;
+  }
+
+  void copyOut(Workspace& w, int* out){
+    for(size_t v = 0; v < adj.size(); v++) { out[v] = w.get(v); }
+  }
+
+public:
+  ShortestPathEngine(const Graph& g, int threads = 0)
+    : adj(g), pool(threads), ws(pool.size(), Workspace(adj.size())) {}
+  //a temporary graph would be gone before the first query
+  ShortestPathEngine(Graph&&, int = 0) = delete;
+
+  size_t size() const { return adj.size(); }
+
+  const Graph& graph() const { return adj; }
+
+  //out[v] = distance from source to v (INF if unreachable)
+  void distances(int source, int* out){
+    run(ws[0], source);
+    copyOut(ws[0], out);
+  }
+
+  int distance(int source, int target){ return run(ws[0], source, target); }
+
+  //out[i*n + v] = distance from sources[i] to v; sources run in parallel
+  void batch(const vi& sources, int* out){
+    atomic<size_t> next(0);
+    size_t n = adj.size();
+    pool.runAll([&](int t){
+	for(size_t i = next++; i < sources.size(); i = next++){
+	  run(ws[t], sources[i]);
+	  copyOut(ws[t], out + i*n);
+	}
+      });
+  }
+
+  //out[i] = distance from queries[i].first to queries[i].second
+  void batch(const vector<pair<int,int> >& queries, int* out){
+    atomic<size_t> next(0);
+    pool.runAll([&](int t){
+	for(size_t i = next++; i < queries.size(); i = next++){
+	  out[i] = run(ws[t], queries[i].first, queries[i].second);
+	}
+      });
+  }
+};
@@ -0,0 +1,247 @@
+#include <vector>
+#include <set>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+#include "csrGraph.cpp"
+#include "binaryHeap.cpp"
+
+//MinHeap walkthrough, then shortest-path checks and timings:
+//- every indexed heap against a std::set, and dijkstra<Heap> on grid,
+//  sparse and dense random, and path-like graphs, with the fastest heap
+//  reported per family
+//- deltaStepping on grid and random graphs, which must give dijkstra's
+//  distances exactly
+//usage: binaryHeapTest [gridSide randomNodes]
+
+void minHeapDemo(){
+  MinHeap<int> h;
+
+  h.insert(5);
+  h.print();
+  h.insert(10);
+  h.print();
+  h.insert(20);
+  h.print();
+  h.insert(12);
+  h.print();
+  h.insert(11);
+  h.print();
+  h.insert(2);
+  h.print();
+
+  h.changeKey(12,7);
+  h.print();
+  h.changeKey(2,12);
+  h.print();
+
+  h.extractMin();
+  h.print();
+}
+
+//side x side grid, edges both ways between neighbours, weights in [1,maxW]
+CSRGraph gridGraph(int side, int maxW, unsigned seed){
+  mt19937 rng(seed);
+  vector<pair<int,int> > edges;
+  vi w;
+  for(int r = 0; r < side; r++){
+    for(int c = 0; c < side; c++){
+      int u = r*side + c;
+      if (c+1 < side) {
+	edges.push_back({u,u+1}); w.push_back(1 + rng()%maxW);
+	edges.push_back({u+1,u}); w.push_back(1 + rng()%maxW);
+      }
+      if (r+1 < side) {
+	edges.push_back({u,u+side}); w.push_back(1 + rng()%maxW);
+	edges.push_back({u+side,u}); w.push_back(1 + rng()%maxW);
+      }
+    }
+  }
+  return CSRGraph(side*side, edges, w);
+}
+
+//n nodes, m directed edges between uniformly random endpoints
+//n nodes along a path (both ways), plus m random shortcuts of higher
+//weight: deep shortest-path trees, small frontiers
+CSRGraph pathGraph(int n, size_t m, int maxW, unsigned seed){
+  mt19937 rng(seed);
+  vector<pair<int,int> > edges;
+  vi w;
+  for(int u = 0; u+1 < n; u++){
+    edges.push_back({u,u+1}); w.push_back(1 + rng()%maxW);
+    edges.push_back({u+1,u}); w.push_back(1 + rng()%maxW);
+  }
+  for(size_t i = 0; i < m; i++){
+    edges.push_back({(int)(rng()%n), (int)(rng()%n)});
+    w.push_back(maxW*(1 + rng()%100));
+  }
+  return CSRGraph(n, edges, w);
+}
+
+CSRGraph randomGraph(int n, size_t m, int maxW, unsigned seed){
+  mt19937 rng(seed);
+  vector<pair<int,int> > edges(m);
+  vi w(m);
+  for(size_t i = 0; i < m; i++){
+    edges[i] = {(int)(rng()%n), (int)(rng()%n)};
+    w[i] = 1 + rng()%maxW;
+  }
+  return CSRGraph(n, edges, w);
+}
+
+double seconds(chrono::steady_clock::time_point start){
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//random insert / changeKey / extractMin sequence checked against a
+//std::set; returns the number of mismatches
+template <typename Heap>
+int checkHeap(const char* name, unsigned seed){
+  mt19937 rng(seed);
+  const int n = 500;
+  Heap h(n);
+  const Heap& view = h;
+  set<pair<int,int> > ref;
+  vi key(n);
+  int failures = 0;
+
+  for(int step = 0; step < 20000; step++){
+    int id = rng()%n;
+    //radix heaps need keys at or above the last minimum
+    int floor = ref.empty() ? 0 : ref.begin()->first;
+    int k = floor + rng()%1000;
+    if (!h.contains(id)) {
+      h.insert(id,k);
+      key[id] = k;
+      ref.insert({k,id});
+    }
+    else if (rng()%2) {
+      h.changeKey(id,k);
+      ref.erase({key[id],id});
+      key[id] = k;
+      ref.insert({k,id});
+    }
+    else {
+      size_t top = view.peekMin();
+      size_t got = h.extractMin();
+      if (got != top || (int)view.size() != (int)ref.size()-1 ||
+	  key[got] != ref.begin()->first) { failures++; }
+      ref.erase({key[got],(int)got});
+    }
+  }
+  if (failures) { printf("%s: %d mismatches\n", name, failures); }
+  return failures;
+}
+
+//times dijkstra<Heap> from node 0 on g; adds a mismatch to failures if
+//the distances differ from expected
+template <typename Heap>
+double timeDijkstra(CSRGraph& g, const vi& expected, int& failures){
+  auto start = chrono::steady_clock::now();
+  vi got;
+  dijkstra<Heap>(g, 0, got);
+  double t = seconds(start);
+  if (got != expected) { failures++; }
+  return t;
+}
+
+//dijkstra with every heap on one graph; prints the timings and the winner
+int compareHeaps(const char* family, CSRGraph& g){
+  vi expected;
+  dijkstra(g, 0, expected);
+
+  int failures = 0;
+  vector<pair<const char*, double> > times = {
+    {"binary (IndexedMinHeap)", timeDijkstra<IndexedMinHeap<int> >(g, expected, failures)},
+    {"2-ary (DaryHeap)", timeDijkstra<DaryHeap<int,2> >(g, expected, failures)},
+    {"4-ary (DaryHeap)", timeDijkstra<DaryHeap<int,4> >(g, expected, failures)},
+    {"8-ary (DaryHeap)", timeDijkstra<DaryHeap<int,8> >(g, expected, failures)},
+    {"radix", timeDijkstra<RadixHeap<int> >(g, expected, failures)},
+    {"pairing", timeDijkstra<PairingHeap<int> >(g, expected, failures)},
+  };
+
+  printf("%s, %zu nodes, %zu edges:\n", family, g.size(), g.numEdges());
+  size_t best = 0;
+  for(size_t i = 0; i < times.size(); i++){
+    printf("  %-24s %.3fs\n", times[i].first, times[i].second);
+    if (times[i].second < times[best].second) { best = i; }
+  }
+  printf("  winner: %s%s\n", times[best].first, failures ? "  (MISMATCH)" : "");
+  return failures;
+}
+
+//returns the number of mismatching runs
+int compareDeltaStepping(const char* name, CSRGraph& g, int maxW, bool report){
+  int failures = 0;
+  auto start = chrono::steady_clock::now();
+  vi expected;
+  dijkstra(g, 0, expected);
+  if (report) { printf("%s, %zu nodes: dijkstra %.3fs\n", name, g.size(), seconds(start)); }
+
+  vi threadCounts(1,1);
+  if (numThreads(0) > 1) { threadCounts.push_back(numThreads(0)); }
+
+  for(int delta: {1, maxW/4 + 1, maxW, 4*maxW}){
+    for(int threads: threadCounts){
+      start = chrono::steady_clock::now();
+      vi got;
+      deltaStepping(g, 0, got, delta, threads);
+      double t = seconds(start);
+      bool ok = got == expected;
+      if (!ok) { failures++; }
+      if (report || !ok) {
+	printf("  delta-stepping (delta %d, %d threads): %.3fs%s\n", delta,
+	       threads, t, ok ? "" : "  MISMATCH");
+      }
+    }
+  }
+  return failures;
+}
+
+int main(int argc, char** argv){
+  minHeapDemo();
+
+  int side = 1000, n = 1000000;
+  if (argc == 3) {
+    side = atoi(argv[1]);
+    n = atoi(argv[2]);
+  }
+
+  int failures = 0;
+  //small graphs first: many shapes, checked quietly
+  mt19937 rng(5);
+  for(int it = 0; it < 200; it++){
+    int maxW = 1 + rng()%50;
+    CSRGraph grid = gridGraph(1 + rng()%20, maxW, it);
+    CSRGraph random = randomGraph(1 + rng()%300, rng()%1200, maxW, it);
+    failures += compareDeltaStepping("grid", grid, maxW, false);
+    failures += compareDeltaStepping("random", random, maxW, false);
+  }
+
+  failures += checkHeap<IndexedMinHeap<int> >("IndexedMinHeap", 1);
+  failures += checkHeap<DaryHeap<int,2> >("DaryHeap<2>", 2);
+  failures += checkHeap<DaryHeap<int,4> >("DaryHeap<4>", 3);
+  failures += checkHeap<DaryHeap<int,8> >("DaryHeap<8>", 4);
+  failures += checkHeap<RadixHeap<int> >("RadixHeap", 5);
+  failures += checkHeap<PairingHeap<int> >("PairingHeap", 6);
+
+  CSRGraph grid = gridGraph(side, 100, 1);
+  CSRGraph random = randomGraph(n, 4*(size_t)n, 100, 1);
+  CSRGraph dense = randomGraph(n/16, 64*(size_t)(n/16), 100, 2);
+  CSRGraph path = pathGraph(n, n/100, 100, 3);
+
+  failures += compareHeaps("grid", grid);
+  failures += compareHeaps("sparse random", random);
+  failures += compareHeaps("dense random", dense);
+  failures += compareHeaps("path-like", path);
+
+  failures += compareDeltaStepping("grid", grid, 100, true);
+  failures += compareDeltaStepping("random", random, 100, true);
+
+  printf("check: %s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
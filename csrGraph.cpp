@@ -0,0 +1,464 @@
+/*Compressed sparse row graph*/
+//Immutable adjacency stored in three flat arrays:
+//the out-edges of u are targets[offsets[u]..offsets[u+1]), with
+//weights[i] the weight of the edge to targets[i]
+//adj[u] yields (neighbor, weight) pairs like an AdjacencyList row,
+//so graph snippets templated on the graph type accept either
+
+//Include-only: files that build with it #include "csrGraph.cpp"
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#ifndef vi
+#define vi vector<int>
+#endif
+#ifndef AdjacencyList
+#define AdjacencyList vector<vector<pair<int,int> > >
+#endif
+
+struct CSRGraph{
+
+  vector<size_t> offsets;
+  vi targets, weights;
+
+  //read-only view of one node's edges
+  //w = 0 means every weight is 1 (an unweighted MappedCSRGraph)
+  struct Neighbors{
+    const int *t, *w, *stop;
+
+    struct iterator{
+      const int *t, *w;
+      pair<int,int> operator*() const { return {*t, w ? *w : 1}; }
+      iterator& operator++() { t++; if (w) { w++; } return *this; }
+      bool operator!=(const iterator& o) const { return t != o.t; }
+    };
+
+    iterator begin() const { return {t,w}; }
+    iterator end() const { return {stop,0}; }
+    size_t size() const { return stop-t; }
+  };
+
+  CSRGraph() : offsets(1,0) {}
+
+  //n nodes; ith edge goes from edges[i].first to edges[i].second
+  //w[i] is its weight (leave w empty for an unweighted graph)
+  CSRGraph(int n, const vector<pair<int,int> >& edges, const vi& w = vi())
+    : offsets(n+1,0), targets(edges.size()), weights(edges.size(),1) {
+    //counting sort of the edges by source
+    for(auto& e: edges) { offsets[e.first+1]++; }
+    for(int u = 0; u < n; u++) { offsets[u+1] += offsets[u]; }
+
+    vector<size_t> next(offsets.begin(), offsets.end()-1);
+    for(size_t i = 0; i < edges.size(); i++){
+      size_t slot = next[edges[i].first]++;
+      targets[slot] = edges[i].second;
+      if (!w.empty()) { weights[slot] = w[i]; }
+    }
+  }
+
+  CSRGraph(const AdjacencyList& adj) : offsets(adj.size()+1,0) {
+    for(size_t u = 0; u < adj.size(); u++){
+      offsets[u+1] = offsets[u] + adj[u].size();
+    }
+    targets.reserve(offsets.back());
+    weights.reserve(offsets.back());
+    for(auto& row: adj){
+      for(auto p: row){
+	targets.push_back(p.first);
+	weights.push_back(p.second);
+      }
+    }
+  }
+
+  size_t size() const { return offsets.size()-1; }
+  size_t numEdges() const { return targets.size(); }
+  size_t degree(int u) const { return offsets[u+1]-offsets[u]; }
+
+  Neighbors operator[](int u) const {
+    const int* t = targets.data();
+    const int* w = weights.data();
+    return {t+offsets[u], w+offsets[u], t+offsets[u+1]};
+  }
+
+};
+
+/*Binary CSR file*/
+//A header, then offsets[n+1] (uint64), targets[m] (int32) and, if the
+//graph is weighted, weights[m] (int32), all in native byte order.
+//The arrays are exactly CSRGraph's, so MappedCSRGraph can serve them
+//straight from the page cache: opening a graph costs one sequential
+//read to validate it, not a parse or a copy. source/sink are the
+//terminals of a flow problem (-1 if there are none).
+
+struct CSRFileHeader{
+  char magic[8];
+  uint64_t nodes, edges;
+  uint32_t weighted, reserved;
+  int64_t source, sink;
+};
+
+static const char CSR_FILE_MAGIC[8] = {'C','S','R','G','R','P','H','1'};
+
+static_assert(sizeof(size_t) == sizeof(uint64_t),
+	      "offsets are stored as 64-bit size_t");
+
+size_t csrFileSize(uint64_t n, uint64_t m, bool weighted){
+  return sizeof(CSRFileHeader) + (n+1)*sizeof(uint64_t) +
+    m*sizeof(int32_t)*(weighted ? 2 : 1);
+}
+
+//returns false if the file can't be written
+bool writeCSR(const char* path, const CSRGraph& g, bool weighted = true,
+	      long long source = -1, long long sink = -1){
+  FILE* f = fopen(path, "wb");
+  if (!f) { return false; }
+
+  CSRFileHeader h;
+  memset(&h, 0, sizeof h);
+  memcpy(h.magic, CSR_FILE_MAGIC, 8);
+  h.nodes = g.size();
+  h.edges = g.numEdges();
+  h.weighted = weighted;
+  h.source = source;
+  h.sink = sink;
+
+  size_t m = g.numEdges();
+  bool ok = fwrite(&h, sizeof h, 1, f) == 1 &&
+    fwrite(g.offsets.data(), sizeof(size_t), g.offsets.size(), f) == g.offsets.size() &&
+    (!m || fwrite(g.targets.data(), sizeof(int), m, f) == m) &&
+    (!m || !weighted || fwrite(g.weights.data(), sizeof(int), m, f) == m);
+  return fclose(f) == 0 && ok;
+}
+
+//Read-only, zero-copy view of a CSR file with CSRGraph's interface,
+//so graph snippets templated on the graph type accept it too
+class MappedCSRGraph{
+
+private:
+  void* base;
+  size_t length;
+  const CSRFileHeader* h;
+  const size_t* off;
+  const int *t, *w;
+
+  void unmap(){
+    if (base) { munmap(base, length); }
+    base = 0;
+    h = 0;
+  }
+
+public:
+  MappedCSRGraph() : base(0), length(0), h(0) {}
+  MappedCSRGraph(const MappedCSRGraph&) = delete;
+  MappedCSRGraph& operator=(const MappedCSRGraph&) = delete;
+  ~MappedCSRGraph() { unmap(); }
+
+  //true if the arrays describe a graph: offsets run from 0 to m without
+  //decreasing and every target (and terminal, if set) is in [0,n)
+  bool validate() const {
+    if (!h) { return false; }
+    size_t n = h->nodes, m = h->edges;
+    if (off[0] != 0 || off[n] != m) { return false; }
+    for(size_t u = 0; u < n; u++){
+      if (off[u] > off[u+1]) { return false; }
+    }
+    for(size_t e = 0; e < m; e++){
+      if (t[e] < 0 || (size_t)t[e] >= n) { return false; }
+    }
+    for(long long x: {h->source, h->sink}){
+      if (x < -1 || x >= (long long)n) { return false; }
+    }
+    return true;
+  }
+
+  //returns false if the file is missing, truncated, not a CSR file or
+  //fails validate()
+  bool open(const char* path){
+    unmap();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CSRFileHeader)) {
+      close(fd);
+      return false;
+    }
+
+    length = st.st_size;
+    base = mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      base = 0;
+      return false;
+    }
+    h = (const CSRFileHeader*) base;
+
+    //bound n and m first so csrFileSize can't overflow
+    if (memcmp(h->magic, CSR_FILE_MAGIC, 8) != 0 ||
+	h->nodes > INT_MAX || h->edges > length/sizeof(int32_t) ||
+	csrFileSize(h->nodes, h->edges, h->weighted) != length) {
+      unmap();
+      return false;
+    }
+
+    off = (const size_t*)(h+1);
+    t = (const int*)(off + h->nodes + 1);
+    w = h->weighted ? t + h->edges : 0;
+    if (!validate()) {
+      unmap();
+      return false;
+    }
+    return true;
+  }
+
+  size_t size() const { return h ? h->nodes : 0; }
+  size_t numEdges() const { return h ? h->edges : 0; }
+  size_t degree(int u) const { return off[u+1]-off[u]; }
+  bool weighted() const { return w != 0; }
+  long long source() const { return h->source; }
+  long long sink() const { return h->sink; }
+
+  CSRGraph::Neighbors operator[](int u) const {
+    return {t+off[u], w ? w+off[u] : 0, t+off[u+1]};
+  }
+
+};
+
+//Text to CSR file converters
+//Both stream the input twice through a read-only mapping (count
+//degrees, then place edges) and write straight into a mapping of the
+//output, so memory use is O(n) however many edges there are.
+//Edges keep their input order within each node, as in CSRGraph(n, edges, w).
+
+//maps a whole file read-only (an empty file gives text = 0, len = 0)
+//returns false if it can't be opened or mapped
+bool mapFile(const char* path, const char*& text, size_t& len){
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+  struct stat st;
+  if (fstat(fd, &st) != 0) { close(fd); return false; }
+
+  len = st.st_size;
+  text = 0;
+  if (len) {
+    void* p = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) { close(fd); return false; }
+    madvise(p, len, MADV_SEQUENTIAL);
+    text = (const char*) p;
+  }
+  close(fd);
+  return true;
+}
+
+void unmapFile(const char* text, size_t len){
+  if (text) { munmap((void*)text, len); }
+}
+
+//moves p to the start of the next line
+void skipLine(const char*& p, const char* end){
+  const char* eol = (const char*) memchr(p, '\n', end-p);
+  p = eol ? eol+1 : end;
+}
+
+//reads up to k integers from the line starting at p into x, and moves
+//p to the start of the next line; returns how many were read, or -1 if
+//the line holds anything else
+int parseLine(const char*& p, const char* end, long long* x, int k){
+  const char* eol = (const char*) memchr(p, '\n', end-p);
+  if (!eol) { eol = end; }
+
+  int count = 0;
+  while(true){
+    while(p < eol && (*p == ' ' || *p == '\t' || *p == '\r')) { p++; }
+    if (p == eol) { break; }
+    if (count == k) { count = -1; break; }
+
+    bool neg = *p == '-';
+    if (neg) { p++; }
+    if (p == eol || *p < '0' || *p > '9') { count = -1; break; }
+    long long v = 0;
+    while(p < eol && *p >= '0' && *p <= '9') { v = 10*v + (*p++ - '0'); }
+    x[count++] = neg ? -v : v;
+  }
+
+  p = eol < end ? eol+1 : end;
+  return count;
+}
+
+//Shared second half of the converters: given node count, degrees and
+//a parser that replays every edge, lays out the output file
+template <typename Replay>
+bool writeCSRStreamed(const char* path, uint64_t n, vector<uint64_t>& degree,
+		      uint64_t m, bool weighted, long long source,
+		      long long sink, Replay replay){
+  size_t len = csrFileSize(n, m, weighted);
+  int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { return false; }
+  if (ftruncate(fd, len) != 0) { close(fd); return false; }
+  void* p = mmap(0, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) { return false; }
+
+  CSRFileHeader* h = (CSRFileHeader*) p;
+  memset(h, 0, sizeof *h);
+  memcpy(h->magic, CSR_FILE_MAGIC, 8);
+  h->nodes = n;
+  h->edges = m;
+  h->weighted = weighted;
+  h->source = source;
+  h->sink = sink;
+
+  size_t* off = (size_t*)(h+1);
+  int* t = (int*)(off + n + 1);
+  int* w = t + m;
+
+  //degree becomes each node's next free slot
+  off[0] = 0;
+  for(uint64_t u = 0; u < n; u++){
+    off[u+1] = off[u] + degree[u];
+    degree[u] = off[u];
+  }
+
+  bool ok = replay([&](long long u, long long v, long long c){
+      size_t slot = degree[u]++;
+      t[slot] = v;
+      if (weighted) { w[slot] = c; }
+    });
+
+  ok = msync(p, len, MS_SYNC) == 0 && ok;
+  munmap(p, len);
+  return ok;
+}
+
+//Text edge list: one "u v" or "u v w" per line, 0-based ids; blank
+//lines and lines starting with # or % are skipped. n is one more than
+//the largest id; the graph is weighted if any line gives a weight
+//(lines without one weigh 1). Returns false on unreadable or malformed
+//input.
+bool edgeListToCSR(const char* in, const char* out){
+  const char* text;
+  size_t len;
+  if (!mapFile(in, text, len)) { return false; }
+  const char* end = text + len;
+
+  //calls f(u, v, w, has a weight) for each edge; false if a line is malformed
+  auto each = [&](auto f){
+    long long x[3];
+    for(const char* p = text; p < end; ){
+      if (*p == '#' || *p == '%') { skipLine(p, end); continue; }
+      int k = parseLine(p, end, x, 3);
+      if (k == 0) { continue; }
+      if (k < 2 || x[0] < 0 || x[1] < 0 || x[0] > INT_MAX || x[1] > INT_MAX ||
+	  (k == 3 && (x[2] < INT_MIN || x[2] > INT_MAX)))
+	{ return false; }
+      f(x[0], x[1], k == 3 ? x[2] : 1, k == 3);
+    }
+    return true;
+  };
+
+  vector<uint64_t> degree;
+  uint64_t m = 0;
+  bool weighted = false;
+  bool ok = each([&](long long u, long long v, long long, bool hasW){
+      uint64_t top = max(u,v);
+      if (top >= degree.size()) { degree.resize(top+1, 0); }
+      degree[u]++;
+      m++;
+      weighted |= hasW;
+    });
+
+  ok = ok && writeCSRStreamed(out, degree.size(), degree, m, weighted, -1, -1,
+			      [&](auto place){
+				return each([&](long long u, long long v,
+						long long c, bool){ place(u,v,c); });
+			      });
+  unmapFile(text, len);
+  return ok;
+}
+
+//DIMACS max-flow: "p max n m", "n id s" / "n id t" and "a u v cap"
+//lines with 1-based ids; "c" lines are comments. Arcs become weighted
+//edges with 0-based ids, and the terminals go in the header.
+//Returns false on unreadable or malformed input.
+bool dimacsToCSR(const char* in, const char* out){
+  const char* text;
+  size_t len;
+  if (!mapFile(in, text, len)) { return false; }
+  const char* end = text + len;
+
+  long long n = -1, m = 0, source = -1, sink = -1;
+
+  //calls f(u,v,cap) for each arc; false if a line is malformed
+  auto each = [&](auto f){
+    long long x[3];
+    for(const char* p = text; p < end; ){
+      while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) { p++; }
+      if (p == end) { break; }
+      char kind = *p;
+      if (kind == '\n') { p++; continue; }
+
+      if (kind == 'p') {
+	p++;
+	while(p < end && (*p == ' ' || *p == '\t')) { p++; }
+	if (end-p < 3 || strncmp(p, "max", 3) != 0) { return false; }
+	p += 3;
+	if (parseLine(p, end, x, 2) != 2 || x[0] < 0 || x[0] > INT_MAX || x[1] < 0)
+	  { return false; }
+	n = x[0];
+	m = x[1];
+      }
+      else if (kind == 'n') {
+	p++;
+	const char* eol = (const char*) memchr(p, '\n', end-p);
+	if (!eol) { eol = end; }
+	//terminal letter comes last: "n 1 s"
+	const char* q = eol;
+	while(q > p && (q[-1] == ' ' || q[-1] == '\t' || q[-1] == '\r')) { q--; }
+	if (q == p || (q[-1] != 's' && q[-1] != 't')) { return false; }
+	char which = q[-1];
+	const char* num = p;
+	if (parseLine(num, q-1, x, 1) != 1 || x[0] < 1 || x[0] > n) { return false; }
+	(which == 's' ? source : sink) = x[0]-1;
+	p = eol < end ? eol+1 : end;
+      }
+      else if (kind == 'a') {
+	p++;
+	if (parseLine(p, end, x, 3) != 3 || n < 0 ||
+	    x[0] < 1 || x[0] > n || x[1] < 1 || x[1] > n ||
+	    x[2] < 0 || x[2] > INT_MAX)
+	  { return false; }
+	f(x[0]-1, x[1]-1, x[2]);
+      }
+      else if (kind == 'c') { skipLine(p, end); }
+      else { return false; }
+    }
+    return true;
+  };
+
+  vector<uint64_t> degree;
+  uint64_t arcs = 0;
+  bool ok = each([&](long long u, long long, long long){
+      if (degree.empty()) { degree.assign(n, 0); }
+      degree[u]++;
+      arcs++;
+    });
+  if (degree.size() < (size_t)max(n,0LL)) { degree.assign(n, 0); }
+  ok = ok && n >= 0 && (long long)arcs == m;
+
+  ok = ok && writeCSRStreamed(out, n, degree, arcs, true, source, sink,
+			      [&](auto place){ return each(place); });
+  unmapFile(text, len);
+  return ok;
+}
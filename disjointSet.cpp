@@ -1,45 +1,150 @@
 #include <algorithm>
 #include <vector>
+#include <queue>
+#include <atomic>
+#include <thread>
 #include <iostream>
-#include <csdtio>
+#include <cstdio>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 
+#include "parallel.cpp"
+
 class DisjointSet{
 
 private:
-  vector<size_t> parent, rank;
+  //parent of i, or -(size of i's set) if i is a root
+  vector<int32_t> p;
 
 public:
-  DisjointSet(size_t n){
-    for (size_t i = 0; i < n; i++){
-      parent.push_back(i);
-      rank.push_back(0);
+  DisjointSet(size_t n) : p(n,-1) {}
+
+  //path halving: every other node on the way up skips to its grandparent
+  size_t findSet(size_t i){
+    while (p[i] >= 0) {
+      if (p[p[i]] >= 0) { p[i] = p[p[i]]; }
+      i = p[i];
+    }
+    return i;
+  }
+
+  //union by size; returns the root of the merged set
+  size_t unionSets(size_t x, size_t y){
+    size_t superior = findSet(x);
+    size_t inferior = findSet(y);
+    if (superior == inferior) { return superior; }
+
+    if (p[superior] > p[inferior]) { swap(superior,inferior); }
+    p[superior] += p[inferior];
+    p[inferior] = superior;
+
+    return superior;
+  }
+
+  size_t setSize(size_t i){ return -p[findSet(i)]; }
+
+  //unions the endpoints of every edge; returns how many merges happened
+  size_t unionMany(const vector<pair<size_t,size_t> >& edges){
+    size_t merges = 0;
+    for(auto& e: edges){
+      size_t x = findSet(e.first);
+      size_t y = findSet(e.second);
+      if (x != y) {
+	unionSets(x,y);
+	merges++;
+      }
     }
+    return merges;
+  }
+
+};
+
+//Disjoint sets that many threads can union and query at once
+//Lock-free: links and path halving are single compare-and-swaps, and a
+//thread whose CAS loses a race just rereads and retries
+//Roots are linked by a fixed pseudo-random priority (Jayanti-Tarjan),
+//which keeps trees shallow in expectation without tracking sizes
+class ConcurrentDisjointSet{
+
+private:
+  vector<atomic<uint32_t> > parent;
+
+  static uint32_t priority(uint32_t i){
+    i ^= i >> 16;
+    i *= 0x7feb352d;
+    i ^= i >> 15;
+    i *= 0x846ca68b;
+    i ^= i >> 16;
+    return i;
+  }
+
+  //does root x rank below root y?
+  static bool below(uint32_t x, uint32_t y){
+    uint32_t px = priority(x), py = priority(y);
+    return px < py || (px == py && x < y);
+  }
+
+public:
+  ConcurrentDisjointSet(size_t n) : parent(n) {
+    for(size_t i = 0; i < n; i++) { parent[i].store(i, memory_order_relaxed); }
   }
 
   size_t findSet(size_t i){
-    if (parent[i] == i) { return i; }
+    uint32_t x = i;
+    while(true){
+      uint32_t p = parent[x].load(memory_order_acquire);
+      if (p == x) { return x; }
+      uint32_t gp = parent[p].load(memory_order_acquire);
+      //halve; if another thread got there first, that's fine too
+      if (p != gp) { parent[x].compare_exchange_weak(p, gp); }
+      x = gp;
+    }
+  }
+
+  //returns true if this call merged two sets
+  bool unionSets(size_t a, size_t b){
+    while(true){
+      uint32_t x = findSet(a);
+      uint32_t y = findSet(b);
+      if (x == y) { return false; }
+      if (below(y,x)) { swap(x,y); }
 
-    size_t ans = findSet(parent[i]);
-    parent[i] = ans;
-    return ans;
+      //x may have stopped being a root since findSet; then retry
+      uint32_t expected = x;
+      if (parent[x].compare_exchange_strong(expected, y)) { return true; }
+    }
   }
 
-  size_t unionSets(size_t x, size_t y){
-    size_t sx = findSet(x);
-    size_t sy = findSet(y);
-    size_t superior = sx;
-    size_t inferior = sy;
-    if (rank[sy] > rank[sx]) { swap(superior,inferior); }
-
-    if (sx != sy) {
-      parent[inferior] = superior;
-      if (rank[superior] == rank[inferior]) { rank[superior]++; }
+  bool sameSet(size_t a, size_t b){
+    while(true){
+      uint32_t x = findSet(a);
+      uint32_t y = findSet(b);
+      if (x == y) { return true; }
+      //x still a root means they really were apart at this moment
+      if (parent[x].load(memory_order_acquire) == x) { return false; }
     }
+  }
 
-    return superior;
+  //unions every edge using all threads; returns how many merges happened
+  size_t unionMany(const vector<pair<size_t,size_t> >& edges,
+		   int threads = 0){
+    atomic<size_t> merges(0);
+    parallelBlocks(numThreads(threads), edges.size(),
+		   [&](size_t lo, size_t hi, int){
+		     size_t local = 0;
+		     for(size_t i = lo; i < hi; i++){
+		       if (unionSets(edges[i].first, edges[i].second)) { local++; }
+		     }
+		     merges += local;
+		   });
+    return merges;
   }
 
 };
@@ -75,3 +180,397 @@ double kruskal(int n, priority_queue<pair<double,size_t> >& pq,
 
   return w;
 }
+
+/*MST on large edge lists*/
+//The functions below take a flat array of WeightedEdge, where
+//edge i plays the part of edges[i] with pq entry (-w, i) in kruskal().
+//They fill treeEdges in the same order, and return the same weight,
+//as kruskal() does on that input.
+
+struct WeightedEdge{
+  uint32_t u, v;
+  double w;
+};
+
+//Edge list file: a header followed by the raw WeightedEdge array,
+//so that MappedEdgeList can hand the mapping straight to the MST code
+struct EdgeFileHeader{
+  char magic[8];
+  uint64_t nodes, edges;
+};
+
+static const char EDGE_FILE_MAGIC[8] = {'E','D','G','E','L','S','T','1'};
+
+//returns false if the file can't be written
+bool writeEdgeList(const char* path, size_t n,
+		   const vector<WeightedEdge>& edges){
+  FILE* f = fopen(path, "wb");
+  if (!f) { return false; }
+
+  EdgeFileHeader h;
+  memcpy(h.magic, EDGE_FILE_MAGIC, 8);
+  h.nodes = n;
+  h.edges = edges.size();
+
+  bool ok = fwrite(&h, sizeof h, 1, f) == 1 &&
+    fwrite(edges.data(), sizeof(WeightedEdge), edges.size(), f) == edges.size();
+  return fclose(f) == 0 && ok;
+}
+
+//Read-only memory mapping of an edge list file; the MST code reads
+//the edges in place and never copies them
+class MappedEdgeList{
+
+private:
+  void* base;
+  size_t length;
+  const EdgeFileHeader* h;
+
+  void unmap(){
+    if (base) { munmap(base, length); }
+    base = 0;
+    h = 0;
+  }
+
+public:
+  MappedEdgeList() : base(0), length(0), h(0) {}
+  MappedEdgeList(const MappedEdgeList&) = delete;
+  MappedEdgeList& operator=(const MappedEdgeList&) = delete;
+  ~MappedEdgeList() { unmap(); }
+
+  //true if the node count fits the int32 disjoint sets and every
+  //endpoint is a node
+  bool validate() const {
+    if (!h || h->nodes > INT32_MAX) { return false; }
+    const WeightedEdge* e = data();
+    for(size_t i = 0; i < h->edges; i++){
+      if (e[i].u >= h->nodes || e[i].v >= h->nodes) { return false; }
+    }
+    return true;
+  }
+
+  //returns false if the file is missing, truncated, not an edge list or
+  //fails validate()
+  bool open(const char* path){
+    unmap();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EdgeFileHeader)) {
+      close(fd);
+      return false;
+    }
+
+    length = st.st_size;
+    base = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      base = 0;
+      return false;
+    }
+    h = (const EdgeFileHeader*) base;
+
+    if (memcmp(h->magic, EDGE_FILE_MAGIC, 8) != 0 ||
+	(length - sizeof(EdgeFileHeader)) / sizeof(WeightedEdge) < h->edges) {
+      unmap();
+      return false;
+    }
+
+    //every edge is read, first front to back and then by index
+    madvise(base, length, MADV_WILLNEED);
+    if (!validate()) {
+      unmap();
+      return false;
+    }
+    return true;
+  }
+
+  size_t nodes() const { return h ? h->nodes : 0; }
+  size_t size() const { return h ? h->edges : 0; }
+  const WeightedEdge* data() const { return (const WeightedEdge*)(h+1); }
+  const WeightedEdge& operator[](size_t i) const { return data()[i]; }
+
+};
+
+//sort key of edge id: its weight, then its position in the input,
+//which breaks weight ties the way kruskal() does (higher index first)
+//Endpoints stay in the input array, so a key is 16 bytes
+struct EdgeKey{
+  double w;
+  size_t id;
+
+  bool operator<(const EdgeKey& o) const {
+    return w < o.w || (w == o.w && id > o.id);
+  }
+};
+
+//in-place parallel partition of a[lo,hi): elements satisfying keep go
+//first (in no particular order); returns where the others start
+//Each thread partitions its own block, then the kept elements right of
+//the split and the dropped ones left of it, equally many, are swapped
+template <typename T, typename Pred>
+size_t parallelPartition(vector<T>& a, size_t lo, size_t hi, int threads,
+			 Pred keep){
+  size_t n = hi-lo;
+  vector<size_t> split(threads);
+  parallelBlocks(threads, n, [&](size_t b, size_t e, int t){
+      split[t] = partition(a.begin()+lo+b, a.begin()+lo+e, keep) - a.begin();
+    });
+
+  size_t mid = lo;
+  for(int t = 0; t < threads; t++) { mid += split[t] - (lo + n*t/threads); }
+
+  //misplaced runs: dropped ones in [lo,mid), kept ones in [mid,hi)
+  vector<pair<size_t,size_t> > dropped, kept;
+  size_t wrong = 0;
+  for(int t = 0; t < threads; t++){
+    size_t b = lo + n*t/threads, e = lo + n*(t+1)/threads;
+    if (split[t] < min(e,mid)) {
+      dropped.push_back({split[t], min(e,mid)});
+      wrong += min(e,mid) - split[t];
+    }
+    if (max(b,mid) < split[t]) { kept.push_back({max(b,mid), split[t]}); }
+  }
+
+  //position of the r-th element of a list of runs
+  auto locate = [](const vector<pair<size_t,size_t> >& runs, size_t r,
+		   size_t& run){
+    for(run = 0; r >= runs[run].second - runs[run].first; run++)
+      { r -= runs[run].second - runs[run].first; }
+    return runs[run].first + r;
+  };
+
+  parallelBlocks(threads, wrong, [&](size_t b, size_t e, int){
+      if (b == e) { return; }
+      size_t dr, kr;
+      size_t i = locate(dropped, b, dr), j = locate(kept, b, kr);
+      for(size_t r = b; r < e; r++){
+	swap(a[i++], a[j++]);
+	if (r+1 < e && i == dropped[dr].second) { i = dropped[++dr].first; }
+	if (r+1 < e && j == kept[kr].second) { j = kept[++kr].first; }
+      }
+    });
+
+  return mid;
+}
+
+//stable in-place parallel filter of a[0,n): the elements satisfying
+//keep move to the front, in their original order; returns how many
+//Each thread compacts its own block, then the blocks are slid left
+//one after another (a sequential copy, since they may overlap)
+template <typename T, typename Pred>
+size_t parallelCompact(vector<T>& a, size_t n, int threads, Pred keep){
+  vector<size_t> kept(threads);
+  parallelBlocks(threads, n, [&](size_t b, size_t e, int t){
+      size_t k = b;
+      for(size_t i = b; i < e; i++){
+	if (keep(a[i])) { a[k++] = a[i]; }
+      }
+      kept[t] = k-b;
+    });
+
+  size_t count = 0;
+  for(int t = 0; t < threads; t++){
+    size_t b = n*t/threads;
+    if (count != b) { move(a.begin()+b, a.begin()+b+kept[t], a.begin()+count); }
+    count += kept[t];
+  }
+  return count;
+}
+
+//Filter-Kruskal (Osipov, Sanders, Singler): quicksort-style split
+//around a pivot edge, solve the light half, then drop every heavy edge
+//whose endpoints the light half already connected before recursing
+//on the rest. Partitioning, filtering and the base-case sort run on
+//all threads; unions stay in sorted order, so the tree comes out in
+//kruskal() order.
+//Works on an array of EdgeKey (16 bytes per edge) and reads endpoints
+//from the input, which is never copied
+class FilterKruskal{
+
+private:
+  const WeightedEdge* edges;
+  vector<EdgeKey> a;
+  ConcurrentDisjointSet ds;
+  vector<pair<size_t,size_t> >& treeEdges;
+  double w;
+  int threads;
+  size_t base;
+
+  void kruskalRange(size_t lo, size_t hi){
+    parallelSort(a.begin()+lo, a.begin()+hi, threads,
+		 [](const EdgeKey& x, const EdgeKey& y){ return x < y; });
+    for(size_t i = lo; i < hi; i++){
+      const WeightedEdge& e = edges[a[i].id];
+      if (ds.unionSets(e.u, e.v)) {
+	treeEdges.push_back({e.u, e.v});
+	w += e.w;
+      }
+    }
+  }
+
+  void solve(size_t lo, size_t hi){
+    if (hi-lo <= base) {
+      kruskalRange(lo,hi);
+      return;
+    }
+
+    //median of evenly spaced samples; never the range's maximum,
+    //so both halves shrink
+    vector<EdgeKey> sample;
+    for(size_t i = 0; i < 31; i++) { sample.push_back(a[lo + (hi-lo)*i/31]); }
+    nth_element(sample.begin(), sample.begin()+15, sample.end());
+    EdgeKey pivot = sample[15];
+
+    size_t mid = parallelPartition(a, lo, hi, threads,
+				   [&](const EdgeKey& k){ return !(pivot < k); });
+    solve(lo, mid);
+
+    size_t end = parallelPartition(a, mid, hi, threads,
+				   [&](const EdgeKey& k){
+				     const WeightedEdge& e = edges[k.id];
+				     return ds.findSet(e.u) != ds.findSet(e.v);
+				   });
+    solve(mid, end);
+  }
+
+public:
+  FilterKruskal(size_t n, const WeightedEdge* edges, size_t m,
+		vector<pair<size_t,size_t> >& treeEdges, int threads)
+    : edges(edges), a(m), ds(n), treeEdges(treeEdges), w(0),
+      threads(numThreads(threads)), base(max<size_t>(2*n, 1<<16)) {
+    int t = this->threads;
+    parallelBlocks(t, m, [&](size_t lo, size_t hi, int){
+	for(size_t i = lo; i < hi; i++) { a[i] = {edges[i].w, i}; }
+      });
+  }
+
+  double run(){
+    solve(0, a.size());
+    return w;
+  }
+
+};
+
+//n nodes, m edges; returns tree weight and fills treeEdges
+//threads = 0 uses every core
+double filterKruskal(size_t n, const WeightedEdge* edges, size_t m,
+		     vector<pair<size_t,size_t> >& treeEdges,
+		     int threads = 0){
+  return FilterKruskal(n, edges, m, treeEdges, threads).run();
+}
+
+double filterKruskal(const MappedEdgeList& edges,
+		     vector<pair<size_t,size_t> >& treeEdges,
+		     int threads = 0){
+  return filterKruskal(edges.nodes(), edges.data(), edges.size(),
+		       treeEdges, threads);
+}
+
+//an edge whose endpoints have been replaced by their components' roots
+//(16 bytes; the weight is read from the input by id)
+struct ContractedEdge{
+  uint32_t u, v;
+  size_t id;
+};
+
+//Boruvka: every round, each component picks its lightest outgoing
+//edge (one CAS-min per endpoint), all picks are unioned at once, and
+//edges now inside one component are discarded. At most log n rounds,
+//each a parallel pass over the surviving edges, so it suits dense
+//graphs with many cores. Ties break as in kruskal(), which makes the
+//MST unique and lets the tree be reported in kruskal() order.
+//Works on an array of ContractedEdge, 16 bytes per edge
+//n nodes, m edges; returns tree weight and fills treeEdges
+double boruvka(size_t n, const WeightedEdge* edges, size_t m,
+	       vector<pair<size_t,size_t> >& treeEdges, int threads = 0){
+  threads = numThreads(threads);
+  const size_t NONE = SIZE_MAX;
+
+  auto key = [&](size_t id){ return EdgeKey{edges[id].w, id}; };
+
+  vector<ContractedEdge> live(m);
+  parallelBlocks(threads, m, [&](size_t lo, size_t hi, int){
+      for(size_t i = lo; i < hi; i++) { live[i] = {edges[i].u, edges[i].v, i}; }
+    });
+
+  ConcurrentDisjointSet ds(n);
+  //input id of each component's lightest outgoing edge
+  vector<atomic<size_t> > best(n);
+  for(auto& b: best) { b.store(NONE, memory_order_relaxed); }
+
+  vector<vector<size_t> > picked(threads);
+  vector<vector<EdgeKey> > tree(threads);
+  size_t count = m;
+
+  while(true){
+    //contract: point each edge at its components' roots, then drop
+    //self-loops and edges already inside one component
+    parallelBlocks(threads, count, [&](size_t lo, size_t hi, int){
+	for(size_t i = lo; i < hi; i++){
+	  live[i].u = ds.findSet(live[i].u);
+	  live[i].v = ds.findSet(live[i].v);
+	}
+      });
+    //stable, so live stays in input order and the weight lookups by id
+    //below walk the input front to back
+    count = parallelCompact(live, count, threads,
+			    [](const ContractedEdge& e){ return e.u != e.v; });
+    if (count == 0) { break; }
+
+    //endpoints are roots, and stay roots until the unions below
+    auto offer = [&](size_t root, const EdgeKey& k){
+      size_t cur = best[root].load(memory_order_relaxed);
+      while((cur == NONE || k < key(cur)) &&
+	    !best[root].compare_exchange_weak(cur, k.id)) {}
+    };
+
+    parallelBlocks(threads, count, [&](size_t lo, size_t hi, int){
+	for(size_t i = lo; i < hi; i++){
+	  EdgeKey k = key(live[i].id);
+	  offer(live[i].u, k);
+	  offer(live[i].v, k);
+	}
+      });
+
+    parallelBlocks(threads, n, [&](size_t lo, size_t hi, int t){
+	for(size_t v = lo; v < hi; v++){
+	  size_t b = best[v].load(memory_order_relaxed);
+	  if (b == NONE) { continue; }
+	  picked[t].push_back(b);
+	  best[v].store(NONE, memory_order_relaxed);
+	}
+      });
+
+    //picks never close a cycle; an edge picked by both of its
+    //components only merges them once
+    parallelBlocks(threads, threads, [&](size_t lo, size_t hi, int){
+	for(size_t t = lo; t < hi; t++){
+	  for(size_t id: picked[t]){
+	    if (ds.unionSets(edges[id].u, edges[id].v)) { tree[t].push_back(key(id)); }
+	  }
+	  picked[t].clear();
+	}
+      });
+  }
+
+  vector<EdgeKey> all;
+  for(auto& t: tree) { all.insert(all.end(), t.begin(), t.end()); }
+  parallelSort(all.begin(), all.end(), threads,
+	       [](const EdgeKey& x, const EdgeKey& y){ return x < y; });
+
+  //endpoints were contracted; report the original ones
+  double w = 0;
+  for(auto& k: all){
+    treeEdges.push_back({edges[k.id].u, edges[k.id].v});
+    w += k.w;
+  }
+  return w;
+}
+
+double boruvka(const MappedEdgeList& edges,
+	       vector<pair<size_t,size_t> >& treeEdges, int threads = 0){
+  return boruvka(edges.nodes(), edges.data(), edges.size(),
+		 treeEdges, threads);
+}
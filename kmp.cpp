@@ -116,3 +116,294 @@ int fillOccurrences(const string& text, const string& pattern, const vi& len,
 
   return counter;
 }
+
+//Resumable KMP over text that arrives in chunks (file blocks, socket
+//reads...): the DFA state carries over between chunks, so matches that
+//straddle a boundary are still found, and chunks are only read, never
+//copied. No unique token is needed: after a full match the state
+//falls back to len[size] by itself.
+//An empty pattern never matches.
+class KmpStream{
+
+private:
+  string pattern;
+  vi len;
+  int state;
+  uint64_t offset;
+
+public:
+  KmpStream(const string& pattern)
+    : pattern(pattern), len(pattern.size()+1, 0), state(0), offset(0) {
+    kmp_build(this->pattern, len);
+  }
+
+  //scans the next chunk, appending the absolute offset (counted from
+  //the first byte ever fed) of each match that ends in it
+  //returns the number of matches found in this chunk
+  size_t feed(string_view chunk, vector<uint64_t>& occurrences){
+    int size = pattern.size();
+    size_t counter = 0;
+
+    if (size) {
+      for (size_t i = 0; i < chunk.size(); i++) {
+
+	while (true) {
+	  if (chunk[i] == pattern[state]) { state++; break; }
+	  else if (state == 0) { break; }
+	  state = len[state];
+	}
+
+	if (state == size) {
+	  counter++;
+	  occurrences.push_back(offset + i + 1 - size);
+	  state = len[size];
+	}
+
+      }
+    }
+
+    offset += chunk.size();
+    return counter;
+  }
+
+  //bytes fed so far
+  uint64_t position() const { return offset; }
+
+  //start over as if nothing had been fed
+  void reset(){
+    state = 0;
+    offset = 0;
+  }
+
+};
+
+//Maps path read-only and calls f(string_view of the whole file); the
+//file is never read into a buffer, so it can be larger than RAM
+//returns false if the file can't be opened or mapped
+template <typename F>
+bool withMappedFile(const char* path, F f){
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  size_t length = st.st_size;
+  if (length == 0) {
+    close(fd);
+    f(string_view());
+    return true;
+  }
+
+  void* p = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) { return false; }
+  madvise(p, length, MADV_SEQUENTIAL);
+
+  f(string_view((const char*)p, length));
+
+  munmap(p, length);
+  return true;
+}
+
+//streams the file at path through a KmpStream
+bool kmpFile(const char* path, const string& pattern,
+	     vector<uint64_t>& occurrences){
+  KmpStream matcher(pattern);
+  return withMappedFile(path, [&](string_view text){
+      matcher.feed(text, occurrences);
+    });
+}
+
+//Branch-free KMP: the full state x byte transition table is built
+//from len up front, so each text byte costs one lookup
+//While the DFA is in state 0 no match is in progress, so it can jump
+//straight to the next place the pattern's rarest byte occurs (its
+//byte frequencies are sampled from the start of the text); that scan
+//is a 16- or 32-byte-wide compare on x86.
+enum KmpPrefilter { KMP_PLAIN, KMP_SSE2, KMP_AVX2, KMP_AUTO };
+
+//x86 only
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+//first index in [from,n) holding b, or n
+size_t findByteSSE2(const char* s, size_t from, size_t n, char b){
+  __m128i needle = _mm_set1_epi8(b);
+  size_t i = from;
+  for (; i + 16 <= n; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i*)(s+i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+    if (mask) { return i + __builtin_ctz(mask); }
+  }
+  for (; i < n; i++) { if (s[i] == b) { return i; } }
+  return n;
+}
+
+__attribute__((target("avx2")))
+size_t findByteAVX2(const char* s, size_t from, size_t n, char b){
+  __m256i needle = _mm256_set1_epi8(b);
+  size_t i = from;
+  for (; i + 32 <= n; i += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i*)(s+i));
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+    if (mask) { return i + __builtin_ctz(mask); }
+  }
+  return findByteSSE2(s, i, n, b);
+}
+#endif
+
+class KmpDFA{
+
+private:
+  string pattern;
+  int size;
+  //next[state*256 + byte] = (next state)*256, so a step is one load
+  //and one add; state size means a match just ended
+  vector<int32_t> next;
+
+  //index in pattern of its byte that is least frequent in sample;
+  //freq gets that byte's count
+  int rarest(string_view sample, size_t& freq) const {
+    size_t count[256] = {0};
+    for (unsigned char ch: sample) { count[ch]++; }
+    int best = 0;
+    for (int i = 1; i < size; i++) {
+      //ties go to later bytes, which skip further
+      if (count[(unsigned char)pattern[i]] <= count[(unsigned char)pattern[best]])
+	{ best = i; }
+    }
+    freq = count[(unsigned char)pattern[best]];
+    return best;
+  }
+
+public:
+  KmpDFA(const string& pattern)
+    : pattern(pattern), size(pattern.size()), next((size+1)*256, 0) {
+    vi len(size+1, 0);
+    kmp_build(pattern, len);
+
+    //a mismatch in state s behaves like the same byte in state len[s],
+    //whose row is already done since len[s] < s
+    for (int s = 0; s <= size; s++) {
+      for (int c = 0; c < 256; c++) {
+	if (s < size && (unsigned char)pattern[s] == c) { next[s*256+c] = (s+1)*256; }
+	else if (s > 0) { next[s*256+c] = next[len[s]*256+c]; }
+      }
+    }
+  }
+
+  int length() const { return size; }
+
+  //KMP_AUTO resolves to the widest scan this CPU runs (search() also
+  //drops it when even the rarest byte is common, e.g. DNA)
+  static KmpPrefilter resolve(KmpPrefilter pf){
+#if defined(__x86_64__) || defined(__i386__)
+    if (pf == KMP_AUTO) {
+      return __builtin_cpu_supports("avx2") ? KMP_AVX2 : KMP_SSE2;
+    }
+    if (pf == KMP_AVX2 && !__builtin_cpu_supports("avx2")) { return KMP_SSE2; }
+    return pf;
+#else
+    return KMP_PLAIN;
+#endif
+  }
+
+  //appends base + the start of each match in text (an empty pattern
+  //never matches); returns the number found
+  size_t search(string_view text, vector<uint64_t>& occurrences,
+		KmpPrefilter pf = KMP_AUTO, uint64_t base = 0) const {
+    if (size == 0) { return 0; }
+    bool automatic = pf == KMP_AUTO;
+    pf = resolve(pf);
+
+    const char* s = text.data();
+    size_t n = text.size();
+    string_view sample = text.substr(0, 1<<16);
+    size_t freq = 0;
+    int r = pf == KMP_PLAIN ? 0 : rarest(sample, freq);
+    char rare = pattern[r];
+    //skipping to a byte that is every few bytes anyway only costs time
+    if (automatic && freq > sample.size()/8) { pf = KMP_PLAIN; }
+    const int32_t* dfa = next.data();
+    const int32_t accept = size*256;
+
+    size_t counter = 0;
+    int32_t state = 0;
+    size_t i = 0;
+
+    if (pf == KMP_PLAIN) {
+      for (; i < n; i++) {
+	state = dfa[state + (unsigned char)s[i]];
+	if (state == accept) {
+	  counter++;
+	  occurrences.push_back(base + i + 1 - size);
+	}
+      }
+      return counter;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    while (i < n) {
+      //nothing in progress: the next match can't start before the
+      //next rare byte, minus its offset in the pattern
+      if (state == 0) {
+	size_t j = pf == KMP_AVX2 ? findByteAVX2(s, i+r, n, rare)
+	  : findByteSSE2(s, i+r, n, rare);
+	if (j >= n) { break; }
+	i = j-r;
+      }
+      state = dfa[state + (unsigned char)s[i++]];
+      if (state == accept) {
+	counter++;
+	occurrences.push_back(base + i - size);
+      }
+    }
+#endif
+
+    return counter;
+  }
+
+};
+
+//Multi-threaded search: text is cut into one piece per thread and each
+//piece runs the DFA concurrently. Piece [lo,hi) is searched up to
+//hi + length - 1, so it sees every match starting in [lo,hi) and no
+//other; no match is reported twice, and concatenating the pieces'
+//lists in order gives the sorted occurrence list.
+//Pieces are at least minPiece bytes, so small texts use fewer threads.
+//returns the number of occurrences
+size_t parallelSearch(const KmpDFA& dfa, string_view text,
+		      vector<uint64_t>& occurrences, int threads = 0,
+		      KmpPrefilter pf = KMP_AUTO, size_t minPiece = 1<<20){
+  size_t n = text.size();
+  size_t overlap = dfa.length() ? dfa.length()-1 : 0;
+  threads = numThreads(threads);
+  threads = max<size_t>(1, min<size_t>(threads, n/minPiece));
+
+  vector<vector<uint64_t> > found(threads);
+  parallelBlocks(threads, n, [&](size_t lo, size_t hi, int t){
+      size_t end = min(n, hi + overlap);
+      dfa.search(text.substr(lo, end-lo), found[t], pf, lo);
+    });
+
+  size_t counter = 0;
+  for(auto& f: found){
+    occurrences.insert(occurrences.end(), f.begin(), f.end());
+    counter += f.size();
+  }
+  return counter;
+}
+
+//parallelSearch over a memory-mapped file; pages are faulted in by
+//whichever thread scans them
+bool parallelKmpFile(const char* path, const string& pattern,
+		     vector<uint64_t>& occurrences, int threads = 0){
+  KmpDFA dfa(pattern);
+  return withMappedFile(path, [&](string_view text){
+      parallelSearch(dfa, text, occurrences, threads);
+    });
+}
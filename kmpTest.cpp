@@ -0,0 +1,150 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#define vi vector<int>
+
+#include "parallel.cpp"
+#include "kmp.cpp"
+
+//Checks KmpDFA::search with every prefilter against brute force, then
+//times the rare-byte prefilter against plain KMP on natural-language
+//text (where the rarest byte of a word is rare) and on DNA (where no
+//byte is).
+//usage: kmpTest [textMB]
+
+const char* prefilterName[] = {"plain", "sse2", "avx2", "auto"};
+
+vector<uint64_t> bruteForce(string_view text, const string& pattern){
+  vector<uint64_t> ret;
+  if (pattern.empty()) { return ret; }
+  for(size_t i = 0; i + pattern.size() <= text.size(); i++){
+    if (text.compare(i, pattern.size(), pattern) == 0) { ret.push_back(i); }
+  }
+  return ret;
+}
+
+int check(){
+  mt19937 rng(22);
+  int failures = 0;
+
+  //small alphabets so that matches overlap; texts long enough to cross
+  //the 16- and 32-byte blocks of the byte scans
+  for(int it = 0; it < 3000; it++){
+    int sigma = 1 + rng()%4;
+    string pattern(rng()%7, 0);
+    for(auto& ch: pattern) { ch = 'a' + rng()%sigma; }
+    string text(rng()%300, 0);
+    for(auto& ch: text) { ch = 'a' + rng()%(sigma+1); }
+
+    auto expected = bruteForce(text, pattern);
+    KmpDFA dfa(pattern);
+    for(KmpPrefilter pf: {KMP_PLAIN, KMP_SSE2, KMP_AVX2, KMP_AUTO}){
+      vector<uint64_t> got;
+      size_t count = dfa.search(text, got, pf);
+      if (count != expected.size() || got != expected) {
+	printf("search (%s): pattern=%s, text of %zu bytes\n",
+	       prefilterName[pf], pattern.c_str(), text.size());
+	failures++;
+      }
+    }
+  }
+
+  return failures;
+}
+
+//english-like text: words of 2-9 letters drawn with english letter
+//frequencies, sentences built from them with Zipf-distributed ranks
+string naturalText(size_t bytes, mt19937& rng){
+  const char* letters = "etaoinshrdlcumwfgypbvkjxqz";
+  vector<double> weights = {12.7, 9.1, 8.2, 7.5, 7.0, 6.7, 6.3, 6.1, 6.0,
+			    4.3, 4.0, 2.8, 2.8, 2.4, 2.4, 2.2, 2.0, 2.0,
+			    1.9, 1.5, 1.0, 0.8, 0.2, 0.2, 0.1, 0.1};
+  discrete_distribution<int> letter(weights.begin(), weights.end());
+
+  vector<string> vocabulary(20000);
+  vector<double> zipf(vocabulary.size());
+  for(size_t w = 0; w < vocabulary.size(); w++){
+    vocabulary[w].resize(2 + rng()%8);
+    for(auto& ch: vocabulary[w]) { ch = letters[letter(rng)]; }
+    zipf[w] = 1.0/(w+1);
+  }
+  discrete_distribution<size_t> word(zipf.begin(), zipf.end());
+
+  string text;
+  text.reserve(bytes + 16);
+  while(text.size() < bytes){
+    text += vocabulary[word(rng)];
+    text += rng()%12 ? ' ' : '\n';
+  }
+  text.resize(bytes);
+  return text;
+}
+
+string dnaText(size_t bytes, mt19937& rng){
+  string text(bytes, 0);
+  for(auto& ch: text) { ch = "ACGT"[rng()%4]; }
+  return text;
+}
+
+//times every prefilter on one text; counts must all agree
+int benchmark(const char* family, const string& text, const string& pattern){
+  KmpDFA dfa(pattern);
+  printf("%s, %zu MB, pattern \"%s\":\n", family, text.size() >> 20,
+	 pattern.c_str());
+
+  int failures = 0;
+  size_t expected = 0;
+  double plain = 0;
+  for(KmpPrefilter pf: {KMP_PLAIN, KMP_SSE2, KMP_AVX2, KMP_AUTO}){
+    vector<uint64_t> occurrences;
+    auto start = chrono::steady_clock::now();
+    size_t found = dfa.search(text, occurrences, pf);
+    chrono::duration<double> t = chrono::steady_clock::now() - start;
+
+    if (pf == KMP_PLAIN) {
+      expected = found;
+      plain = t.count();
+    }
+    bool ok = found == expected;
+    if (!ok) { failures++; }
+    printf("  %-6s %zu matches in %.3fs  %.0f MB/s  %.1fx%s\n",
+	   prefilterName[pf], found, t.count(), text.size()/t.count()/1e6,
+	   plain/t.count(), ok ? "" : "  MISMATCH");
+  }
+  return failures;
+}
+
+int main(int argc, char** argv){
+  int failures = check();
+  printf("check: %s\n", failures ? "FAILED" : "ok");
+
+  size_t textMB = argc == 2 ? atoi(argv[1]) : 64;
+  mt19937 rng(1);
+
+  //a word holding an uncommon letter, and a two-word phrase taken from
+  //the middle of the text
+  string natural = naturalText(textMB << 20, rng);
+  size_t at = natural.find(' ', natural.size()/2) + 1;
+  size_t end = natural.find(' ', natural.find(' ', at) + 1);
+  failures += benchmark("natural language", natural, "quartz");
+  failures += benchmark("natural language", natural, natural.substr(at, end-at));
+
+  //a 20-mer from the text: every byte is a quarter of the text, so
+  //auto falls back to plain
+  string dna = dnaText(textMB << 20, rng);
+  failures += benchmark("DNA", dna, dna.substr(textMB << 19, 20));
+
+  return failures ? 1 : 0;
+}
@@ -1,13 +1,34 @@
+//Include-only: files that build with it #include "maxFlow.cpp"
+//(maxFlowBench.cpp times the algorithms)
+#pragma once
+
 #include <iostream>
 #include <vector>
 #include <map>
 #include <queue>
 #include <algorithm>
 #include <climits>
+#include <limits>
+#include <cassert>
 
+#ifndef ll
 #define ll long long
+#endif
+#ifndef vi
 #define vi vector<int>
+#endif
+#ifndef vll
 #define vll vector<ll>
+#endif
+
+/*
+  Max flow, min cut and min-cost flow on one flat residual arc layout
+  (FlowNetwork), templated on the capacity type (int, ll, double).
+  maxFlow<Algorithm> picks EdmondsKarp, Dinic or PushRelabel (default).
+
+  The map-based front ends take either residual representation:
+  adj[u][v] = Edge(capacity, flow) or adj[u][v] = Capacity(original, residual)
+*/
 
 //For node u, adj[u] is a map from neighbor v to {capacity, flow}
 //In short, adj[u][v] = Edge(capacity, flow)
@@ -15,6 +36,9 @@
 
 using namespace std;
 
+#include "csrGraph.cpp"
+#include "binaryHeap.cpp"
+
 struct Edge{
   ll capacity, flow;
   Edge(): capacity(0), flow(0) {}
@@ -31,113 +55,587 @@ void initEdge(ll cap, Edge& uv, Edge& vu, bool undirected){
   vu = Edge(cap, undirected);
 }
 
-//Edmonds-Karp (BFS)
-void findAugPath(int source, int sink,
-		 vector<ListEntry>& adj,
-		 vi& parent){
-  queue<int> q;
-  q.push(source);
+//Alternative entry: adj[u][v] = Capacity(original capacity, residual)
+//an "infinite" (LLONG_MAX) capacity should be set up as undirected
+struct Capacity{
+  ll original, residual;
+  Capacity(): original(0), residual(0) {}
+  Capacity(ll cap, bool forward) : residual(cap) {
+    if (forward) { original = cap; }
+    else { original = 0; }
+  }
+};
 
-  while(!q.empty()){
-    int u = q.front();
-    q.pop();
+void initCapacity(ll cap, Capacity& uv, Capacity& vu, bool undirected){
+  uv = Capacity(cap, true);
+  vu = Capacity(cap, undirected);
+}
 
-    for(auto p: adj[u]){
-      int v = p.first;
-      Edge e = p.second;
-      ll capacity = e.capacity;
-      ll flow = e.flow;
+//what the map-based front ends need from either entry type
+ll entryCapacity(const Edge& e) { return e.capacity; }
+ll entryResidual(const Edge& e) { return e.capacity - e.flow; }
+void setEntryFlow(Edge& e, ll f) { e.flow = f; }
+
+ll entryCapacity(const Capacity& c) { return c.original; }
+ll entryResidual(const Capacity& c) { return c.residual; }
+//infinite capacities never run out, so their residual stays put
+void setEntryFlow(Capacity& c, ll f) {
+  if (c.original != LLONG_MAX) { c.residual = c.original - f; }
+}
+
+//is there capacity left? floating-point leftovers below EPS don't count
+template <typename Cap>
+bool hasRoom(Cap r) { return r > 0; }
+
+bool hasRoom(double r) { return r > 1e-9; }
+
+//Residual network in flat arrays
+//arc a goes to head[a] with residual capacity res[a] (original cap[a])
+//and cost[a] per unit; arcs are added in pairs, so a^1 is the reverse of a
+//arcsOf[start[u]..start[u+1]) lists the arcs leaving u contiguously;
+//index() rebuilds it and must be called after adding arcs
+template <typename Cap = ll>
+struct FlowNetwork{
+  int n;
+  vi head;
+  vector<Cap> res, cap;
+  vll cost;
+  vector<size_t> start, arcsOf;
+
+  FlowNetwork(int n = 0) : n(n), start(n+1,0) {}
+
+  //weights of g are the capacities
+  //Graph is a CSRGraph or a MappedCSRGraph
+  template <typename Graph>
+  explicit FlowNetwork(const Graph& g) : n(g.size()) {
+    for(int u = 0; u < n; u++){
+      for(auto p: g[u]) { addEdge(u, p.first, p.second); }
+    }
+    index();
+  }
+
+  //returns the arc id of u->v; if undirected, v->u gets cap as well
+  size_t addEdge(int u, int v, Cap c, bool undirected = false){
+    size_t a = head.size();
+    head.push_back(v);
+    head.push_back(u);
+    res.push_back(c);
+    res.push_back(undirected ? c : 0);
+    cap.push_back(c);
+    cap.push_back(undirected ? c : 0);
+    cost.push_back(0);
+    cost.push_back(0);
+    return a;
+  }
+
+  //u->v with capacity c at w per unit; sending back refunds w
+  size_t addCostEdge(int u, int v, Cap c, ll w){
+    size_t a = addEdge(u, v, c);
+    cost[a] = w;
+    cost[a^1] = -w;
+    return a;
+  }
 
-      //cannot flow backwards if we haven't flowed forwards
-      bool isBackward = (capacity == 0);
-      bool haventForward = (adj[v][u].flow == 0);
-      if (isBackward && haventForward) { continue; }
+  int tail(size_t a) const { return head[a^1]; }
 
-      ll residual = capacity - flow;
+  Cap flow(size_t a) const { return cap[a] - res[a]; }
 
-      //if we haven't seen this node before and we can send flow
-      if (parent[v] == INT_MAX && residual > 0) {
-	parent[v] = u;
+  void index(){
+    start.assign(n+1,0);
+    for(size_t a = 0; a < head.size(); a++) { start[tail(a)+1]++; }
+    for(int u = 0; u < n; u++) { start[u+1] += start[u]; }
 
-	if (v == sink) { break; }
-	else { q.push(v); }
+    arcsOf.resize(head.size());
+    vector<size_t> pos(start.begin(), start.end()-1);
+    for(size_t a = 0; a < head.size(); a++) { arcsOf[pos[tail(a)]++] = a; }
+  }
+
+  //marks nodes reachable from source through arcs with residual capacity
+  void reachable(int source, vector<bool>& seen) const {
+    seen.assign(n,false);
+    vi q(1,source);
+    seen[source] = true;
+    for(size_t i = 0; i < q.size(); i++){
+      int u = q[i];
+      for(size_t j = start[u]; j < start[u+1]; j++){
+	size_t a = arcsOf[j];
+	if (hasRoom(res[a]) && !seen[head[a]]) {
+	  seen[head[a]] = true;
+	  q.push_back(head[a]);
+	}
       }
     }
-
-    if (parent[sink] != INT_MAX) { break; }
   }
-  /*
-  for(int u = 0; u < adj.size(); u++){
-    printf("(%d %d) ",u,parent[u]);
+};
+
+//Edmonds-Karp (BFS) on a FlowNetwork; kept for comparison
+template <typename Cap>
+Cap edmondsKarp(FlowNetwork<Cap>& net, int source, int sink) {
+  const size_t NONE = (size_t)-1;
+  int n = net.n;
+
+  Cap ans = 0;
+  vector<size_t> parentArc(n);
+  vi q(n);
+  while(true){
+    fill(parentArc.begin(), parentArc.end(), NONE);
+    size_t qHead = 0, qTail = 0;
+    q[qTail++] = source;
+
+    while(qHead < qTail && parentArc[sink] == NONE){
+      int u = q[qHead++];
+      for(size_t i = net.start[u]; i < net.start[u+1]; i++){
+	size_t arc = net.arcsOf[i];
+	int v = net.head[arc];
+	if (v != source && parentArc[v] == NONE && hasRoom(net.res[arc])) {
+	  parentArc[v] = arc;
+	  q[qTail++] = v;
+	}
+      }
+    }
+
+    //no augmenting path
+    if (parentArc[sink] == NONE) { break; }
+
+    Cap flow = numeric_limits<Cap>::max();
+    for(int v = sink; v != source; v = net.tail(parentArc[v])){
+      flow = min(flow, net.res[parentArc[v]]);
+    }
+    for(int v = sink; v != source; v = net.tail(parentArc[v])){
+      net.res[parentArc[v]] -= flow;
+      net.res[parentArc[v]^1] += flow;
+    }
+    ans += flow;
   }
-  printf("\n");
-  */
+
+  return ans;
 }
 
+//Highest-label push-relabel with the global-relabel and gap heuristics
+//Runs until no node holds excess, so net ends with a valid max flow:
+//nodes cut off from the sink climb above n and return excess to the source
+//NB: the source's arcs are saturated up front, so their total must fit in Cap
+template <typename Cap>
+Cap pushRelabel(FlowNetwork<Cap>& net, int source, int sink) {
+  int n = net.n;
+  if (source == sink) { return 0; }
+
+  int maxH = 2*n;
+  vector<Cap> excess(n,0);
+  vi height(n), count(maxH+1);
+  vector<size_t> cur(n);
+  //active[h] holds nodes with excess at height h; stale entries are skipped
+  vector<vi> active(maxH+1);
+  int highest = 0;
+
+  auto activate = [&](int v){
+    if (v == source || v == sink) { return; }
+    active[height[v]].push_back(v);
+    highest = max(highest, height[v]);
+  };
+
+  //exact heights: distance to the sink in the residual graph, or
+  //n + distance to the source for nodes that can no longer reach the sink
+  auto globalRelabel = [&](){
+    fill(height.begin(), height.end(), maxH);
+    height[sink] = 0;
+    height[source] = n;
+    vi q;
+    for(int root: {sink, source}){
+      q.assign(1,root);
+      for(size_t i = 0; i < q.size(); i++){
+	int u = q[i];
+	for(size_t j = net.start[u]; j < net.start[u+1]; j++){
+	  size_t a = net.arcsOf[j];
+	  int v = net.head[a];
+	  if (hasRoom(net.res[a^1]) && height[v] == maxH) {
+	    height[v] = height[u]+1;
+	    q.push_back(v);
+	  }
+	}
+      }
+    }
 
-ll sendFlow(int source, int sink,
-	    vector<ListEntry>& adj,
-	    vi& parent){
-  //no augmenting path
-  if (parent[sink] == INT_MAX) {
-    //cout << "no path" << endl;
-    return 0;
+    fill(count.begin(), count.end(), 0);
+    for(auto& bucket: active) { bucket.clear(); }
+    highest = 0;
+    for(int v = 0; v < n; v++){
+      count[height[v]]++;
+      cur[v] = net.start[v];
+      if (hasRoom(excess[v])) { activate(v); }
+    }
+  };
+
+  //nothing between height k and n can reach the sink any more
+  auto gap = [&](int k){
+    for(int v = 0; v < n; v++){
+      if (height[v] > k && height[v] < n) {
+	count[height[v]]--;
+	height[v] = n+1;
+	count[n+1]++;
+	cur[v] = net.start[v];
+	if (hasRoom(excess[v])) { activate(v); }
+      }
+    }
+  };
+
+  auto push = [&](int u, size_t a, Cap f){
+    int v = net.head[a];
+    net.res[a] -= f;
+    net.res[a^1] += f;
+    excess[u] -= f;
+    if (!hasRoom(excess[v])) { activate(v); }
+    excess[v] += f;
+  };
+
+  for(size_t j = net.start[source]; j < net.start[source+1]; j++){
+    size_t a = net.arcsOf[j];
+    if (hasRoom(net.res[a])) { push(source, a, net.res[a]); }
   }
+  //push() queued nodes by their old heights; globalRelabel requeues them
+  globalRelabel();
+
+  int relabels = 0;
+  while(highest >= 0){
+    if (active[highest].empty()) { highest--; continue; }
+
+    int u = active[highest].back();
+    active[highest].pop_back();
+    if (height[u] != highest || !hasRoom(excess[u])) { continue; }
+
+    //discharge u
+    while(hasRoom(excess[u]) && height[u] < maxH){
+      if (cur[u] == net.start[u+1]) {
+	//relabel
+	int oldH = height[u];
+	int newH = maxH;
+	for(size_t j = net.start[u]; j < net.start[u+1]; j++){
+	  size_t a = net.arcsOf[j];
+	  if (hasRoom(net.res[a])) { newH = min(newH, height[net.head[a]]+1); }
+	}
+	count[oldH]--;
+	height[u] = newH;
+	count[newH]++;
+	cur[u] = net.start[u];
+	relabels++;
+
+	if (count[oldH] == 0 && oldH < n) { gap(oldH); }
+	continue;
+      }
+
+      size_t a = net.arcsOf[cur[u]];
+      int v = net.head[a];
+      if (hasRoom(net.res[a]) && height[u] == height[v]+1) {
+	push(u, a, min(excess[u], net.res[a]));
+      }
+      else { cur[u]++; }
+    }
 
-  //get min residual
-  ll ans = LLONG_MAX;
-  int v = sink;
-  while(v != source){
-    int u = parent[v];
-    ll capacity = adj[u][v].capacity;
-    
-    ll residual = LLONG_MAX;
-    if (capacity != LLONG_MAX) { residual = capacity - adj[u][v].flow; }
-    
-    if (ans > residual) { ans = residual; }
-    v = u;
+    if (relabels >= n) {
+      relabels = 0;
+      globalRelabel();
+    }
   }
 
-  //send the residual flow
-  v = sink;
-  while(v != source){
-    int u = parent[v];
-    //forwards
-    adj[u][v].flow += ans;
-    //backwards
-    adj[v][u].flow -= ans;
+  return excess[sink];
+}
 
-    v = u;
+//Dinic: a BFS builds levels by distance from the source, then a blocking
+//flow is pushed along arcs that go exactly one level further
+//cur[u] is the first arc of u not yet known to be useless this phase,
+//so each arc is skipped at most once per phase
+//The DFS keeps its path in an explicit arc stack instead of recursing
+//O(E sqrt V) on unit-capacity networks such as bipartite matchings
+template <typename Cap>
+Cap dinic(FlowNetwork<Cap>& net, int source, int sink) {
+  int n = net.n;
+  if (source == sink) { return 0; }
+
+  vi level(n), q(n);
+  vector<size_t> cur(n), path;
+
+  auto bfs = [&](){
+    fill(level.begin(), level.end(), -1);
+    size_t qHead = 0, qTail = 0;
+    level[source] = 0;
+    q[qTail++] = source;
+    while(qHead < qTail){
+      int u = q[qHead++];
+      for(size_t j = net.start[u]; j < net.start[u+1]; j++){
+	size_t a = net.arcsOf[j];
+	int v = net.head[a];
+	if (hasRoom(net.res[a]) && level[v] == -1) {
+	  level[v] = level[u]+1;
+	  q[qTail++] = v;
+	}
+      }
+    }
+    return level[sink] != -1;
+  };
+
+  Cap ans = 0;
+  while(bfs()){
+    for(int u = 0; u < n; u++) { cur[u] = net.start[u]; }
+    path.clear();
+    int u = source;
+
+    while(true){
+      if (u == sink) {
+	Cap f = numeric_limits<Cap>::max();
+	for(size_t a: path) { f = min(f, net.res[a]); }
+	//retreat to just before the first arc this saturates
+	size_t keep = path.size();
+	for(size_t i = 0; i < path.size(); i++){
+	  net.res[path[i]] -= f;
+	  net.res[path[i]^1] += f;
+	  if (!hasRoom(net.res[path[i]]) && keep == path.size()) { keep = i; }
+	}
+	ans += f;
+	u = net.tail(path[keep]);
+	path.resize(keep);
+	continue;
+      }
+
+      //advance along the current arc if it still leads one level down
+      bool advanced = false;
+      for(; cur[u] < net.start[u+1]; cur[u]++){
+	size_t a = net.arcsOf[cur[u]];
+	int v = net.head[a];
+	if (hasRoom(net.res[a]) && level[v] == level[u]+1) {
+	  path.push_back(a);
+	  u = v;
+	  advanced = true;
+	  break;
+	}
+      }
+      if (advanced) { continue; }
+
+      //u is a dead end this phase
+      if (u == source) { break; }
+      level[u] = -1;
+      size_t a = path.back();
+      path.pop_back();
+      u = net.tail(a);
+      cur[u]++;
+    }
   }
 
   return ans;
-}  
+}
 
-//Ford Fulkerson
-//NB: if there is a(n anti)parallel edge, insert an intermediary node
-ll maxFlow(int source, int sink, vector<ListEntry>& adj) {
-  ll ans = 0;
+//Hopcroft-Karp style maximum bipartite matching via dinic
+//left nodes 0..L-1, right nodes 0..R-1; edges are (left, right) pairs
+//fills matchL[i] with i's partner on the right, or -1
+//returns the size of the matching
+int bipartiteMatching(int L, int R, const vector<pair<int,int> >& edges,
+		      vi& matchL){
+  int source = L+R, sink = L+R+1;
+  FlowNetwork<int> net(L+R+2);
+  for(int i = 0; i < L; i++) { net.addEdge(source, i, 1); }
+  for(int j = 0; j < R; j++) { net.addEdge(L+j, sink, 1); }
+
+  size_t first = net.head.size();
+  for(auto& e: edges) { net.addEdge(e.first, L+e.second, 1); }
+  net.index();
+
+  int ans = dinic(net, source, sink);
+
+  matchL.assign(L,-1);
+  for(size_t a = first; a < net.head.size(); a += 2){
+    if (net.flow(a) > 0) { matchL[net.tail(a)] = net.head[a]-L; }
+  }
 
-  while(true){
-    vi parent;
-    for(auto i: adj) { parent.push_back(INT_MAX); }
-    parent[source] = -1;
+  return ans;
+}
 
-    findAugPath(source,sink,adj,parent);
-    //cout << "ended search for sink" << endl;
+//Min-cost flow by successive shortest paths
+//Sends up to maxFlow units from source to sink (all it can by default),
+//always along the cheapest residual path. Johnson potentials keep reduced
+//costs non-negative, so each path is found by dijkstra on a DaryHeap;
+//one Bellman-Ford pass first sets them up if some costs are negative
+//NB: no negative-cost cycles
+//returns {flow sent, its total cost}; the flow is left in net
+template <typename Cap>
+pair<Cap, decltype(Cap()*(ll)0)>
+minCostFlow(FlowNetwork<Cap>& net, int source, int sink,
+	    Cap maxFlow = numeric_limits<Cap>::max()) {
+  const ll INF_COST = LLONG_MAX;
+  const size_t NONE = (size_t)-1;
+  int n = net.n;
+
+  vll pot(n,0), dist(n);
+  vector<size_t> parentArc(n);
+
+  bool negative = false;
+  for(size_t a = 0; a < net.head.size(); a++){
+    if (hasRoom(net.res[a]) && net.cost[a] < 0) { negative = true; }
+  }
+  if (negative) {
+    fill(pot.begin(), pot.end(), INF_COST);
+    pot[source] = 0;
+    for(int i = 1; i < n; i++){
+      bool changed = false;
+      for(size_t a = 0; a < net.head.size(); a++){
+	int u = net.tail(a);
+	if (hasRoom(net.res[a]) && pot[u] != INF_COST
+	    && pot[u] + net.cost[a] < pot[net.head[a]]) {
+	  pot[net.head[a]] = pot[u] + net.cost[a];
+	  changed = true;
+	}
+      }
+      if (!changed) { break; }
+    }
+    for(auto& p: pot) { if (p == INF_COST) { p = 0; } }
+  }
 
-    ll flow = sendFlow(source,sink,adj,parent);
-    //cout << "sent flow " << flow << endl;
+  Cap flow = 0;
+  decltype(Cap()*(ll)0) cost = 0;
+  DaryHeap<ll,4> pq(n);
+  while(flow < maxFlow){
+    fill(dist.begin(), dist.end(), INF_COST);
+    fill(parentArc.begin(), parentArc.end(), NONE);
+    dist[source] = 0;
+    pq.insert(source, 0);
+
+    ll farthest = 0;
+    while(!pq.empty()){
+      int u = pq.extractMin();
+      farthest = dist[u];
+      for(size_t j = net.start[u]; j < net.start[u+1]; j++){
+	size_t a = net.arcsOf[j];
+	if (!hasRoom(net.res[a])) { continue; }
+	int v = net.head[a];
+	ll d = dist[u] + net.cost[a] + pot[u] - pot[v];
+	if (d < dist[v]) {
+	  if (dist[v] == INF_COST) { pq.insert(v,d); }
+	  else { pq.decreaseKey(v,d); }
+	  dist[v] = d;
+	  parentArc[v] = a;
+	}
+      }
+    }
+    if (dist[sink] == INF_COST) { break; }
 
-    ans += flow;
-    if (flow == 0) { break; }
+    //unreached nodes move up with the farthest one, which keeps every
+    //residual reduced cost non-negative
+    for(int v = 0; v < n; v++){
+      pot[v] += (dist[v] == INF_COST) ? farthest : dist[v];
+    }
+
+    Cap f = maxFlow - flow;
+    for(int v = sink; v != source; v = net.tail(parentArc[v]))
+      { f = min(f, net.res[parentArc[v]]); }
+    for(int v = sink; v != source; v = net.tail(parentArc[v])){
+      net.res[parentArc[v]] -= f;
+      net.res[parentArc[v]^1] += f;
+      cost += f * net.cost[parentArc[v]];
+    }
+    flow += f;
+  }
+
+  return {flow, cost};
+}
+
+//Algorithm choices for maxFlow<Algorithm>(...)
+struct EdmondsKarp{
+  template <typename Cap>
+  static Cap run(FlowNetwork<Cap>& net, int source, int sink)
+  { return edmondsKarp(net, source, sink); }
+};
+
+struct Dinic{
+  template <typename Cap>
+  static Cap run(FlowNetwork<Cap>& net, int source, int sink)
+  { return dinic(net, source, sink); }
+};
+
+struct PushRelabel{
+  template <typename Cap>
+  static Cap run(FlowNetwork<Cap>& net, int source, int sink)
+  { return pushRelabel(net, source, sink); }
+};
+
+//same as maxFlow below, leaving the flow in net
+template <typename Algorithm = PushRelabel, typename Cap>
+Cap maxFlow(int source, int sink, FlowNetwork<Cap>& net) {
+  return Algorithm::run(net, source, sink);
+}
+
+//max flow on a CSRGraph whose weights are the edge capacities
+template <typename Algorithm = PushRelabel>
+ll maxFlow(int source, int sink, const CSRGraph& g) {
+  FlowNetwork<ll> net(g);
+  return Algorithm::run(net, source, sink);
+}
+
+//max flow on a mapped CSR file, e.g. one written by dimacsToCSR
+template <typename Algorithm = PushRelabel>
+ll maxFlow(int source, int sink, const MappedCSRGraph& g) {
+  FlowNetwork<ll> net(g);
+  return Algorithm::run(net, source, sink);
+}
+
+//as above, between the terminals stored in the file
+//returns -1 if the file has none
+template <typename Algorithm = PushRelabel>
+ll maxFlow(const MappedCSRGraph& g) {
+  if (g.source() < 0 || g.sink() < 0) { return -1; }
+  return maxFlow<Algorithm>(g.source(), g.sink(), g);
+}
+
+//Ford Fulkerson semantics: on return the entries of adj hold the flow
+//(Edge::flow, or Capacity::residual)
+//Solved on a FlowNetwork with one arc pair per {u,v}
+//Infinite (LLONG_MAX) capacities are clamped to the sum of finite ones,
+//which no cut can exceed
+//NB: if there is a(n anti)parallel edge, insert an intermediary node
+template <typename Algorithm = PushRelabel, typename Entry>
+ll maxFlow(int source, int sink, vector<map<int,Entry> >& adj) {
+  int n = adj.size();
+
+  ll finite = 1;
+  for(auto& row: adj){
+    for(auto& p: row){
+      ll c = entryCapacity(p.second);
+      if (c != LLONG_MAX) { finite += c; }
+    }
+  }
+  auto clamp = [&](ll c){ return c == LLONG_MAX ? finite : c; };
+
+  FlowNetwork<ll> net(n);
+  vector<size_t> arcs;
+  for(int u = 0; u < n; u++){
+    for(auto& p: adj[u]){
+      int v = p.first;
+      if (v < u && adj[v].count(u)) { continue; }
+
+      size_t a = net.addEdge(u, v, clamp(entryCapacity(p.second)));
+      auto back = adj[v].find(u);
+      ll backCap = 0;
+      if (back != adj[v].end()) { backCap = clamp(entryCapacity(back->second)); }
+      net.res[a^1] = net.cap[a^1] = backCap;
+      arcs.push_back(a);
+    }
+  }
+  net.index();
+
+  ll ans = Algorithm::run(net, source, sink);
+
+  //net flow from tail to head is what the forward arc lost
+  for(size_t a: arcs){
+    int u = net.tail(a), v = net.head[a];
+    ll f = net.flow(a);
+    setEntryFlow(adj[u][v], f);
+    if (adj[v].count(u)) { setEntryFlow(adj[v][u], -f); }
   }
 
   return ans;
 }
 
 //BFS to flag nodes reachable from the source
-void findCC(int source, vector<ListEntry>& adj, vector<bool>& reachable){
+template <typename Entry>
+void findCC(int source, vector<map<int,Entry> >& adj,
+	    vector<bool>& reachable){
   queue<int> q;
   q.push(source);
   reachable[source] = true;
@@ -146,12 +644,11 @@ void findCC(int source, vector<ListEntry>& adj, vector<bool>& reachable){
     int u = q.front();
     q.pop();
 
-    for(auto p: adj[u]) {
+    for(auto& p: adj[u]) {
       int v = p.first;
-      Edge e = p.second;
 
-      //Is uv a forward edge that has some space left?
-      if (!reachable[v] && e.original != 0 && e.capacity > e.flow) {
+      //Does uv have residual capacity? (backward edges do once used)
+      if (!reachable[v] && entryResidual(p.second) > 0) {
 	reachable[v] = true;
 	q.push(v);
       }
@@ -162,32 +659,179 @@ void findCC(int source, vector<ListEntry>& adj, vector<bool>& reachable){
 }
 
 
-ll minCut(int source, int sink, vector<ListEntry>& adj,
+template <typename Entry>
+ll minCut(int source, int sink, vector<map<int,Entry> >& adj,
 	  vector<pair<int,int> >& cut) {
 
   ll ans = maxFlow(source, sink, adj);
 
+  int n = adj.size();
+
   //reachable[u] iff u is reachable from source
-  vector<bool> reachable;
+  vector<bool> reachable(n,false);
 
-  for(int i = 0; i < adj.size(); i++){ reachable.push_back(false);  }
-  
   findCC(source,adj,reachable);
 
-  for(int u = 0; u < adj.size(); u++){
+  for(int u = 0; u < n; u++){
     // reachable to unreachable, not other way around
     if (!reachable[u]) { continue; }
 
-    for(auto p: adj[u]) {
+    for(auto& p: adj[u]) {
       int v = p.first;
-      
-      if (!reachable[v]) { cut.push_back({u,v}); }
+
+      //skip backward edges, which have no capacity of their own
+      if (!reachable[v] && entryCapacity(p.second) > 0) { cut.push_back({u,v}); }
     }
   }
 
   return ans;
 }
 
-int main(){
+//min cut on a FlowNetwork: fills cut with arcs (by id) leaving the
+//source side; their capacities add up to the returned max flow
+template <typename Algorithm = PushRelabel, typename Cap>
+Cap minCut(int source, int sink, FlowNetwork<Cap>& net, vector<size_t>& cut) {
+  Cap ans = maxFlow<Algorithm>(source, sink, net);
 
+  vector<bool> reachable;
+  net.reachable(source, reachable);
+  for(size_t a = 0; a < net.head.size(); a++){
+    if (reachable[net.tail(a)] && !reachable[net.head[a]] && net.cap[a] > 0)
+      { cut.push_back(a); }
+  }
+
+  return ans;
 }
+
+//Max flow that is kept up to date as the network changes
+//Capacity edits and new arcs patch the current flow instead of
+//discarding it; solve() then only augments from there (with dinic)
+//The residual network and the min cut stay available between solves
+template <typename Cap = ll>
+class IncrementalFlow{
+private:
+  FlowNetwork<Cap> net;
+  int source, sink;
+  Cap value;
+  bool dirty;
+  //sourceSide is stale until solve() runs after the latest change
+  vector<bool> sourceSide;
+  bool cutStale;
+
+  //pushes up to limit units from -> to along residual paths (BFS)
+  Cap augment(int from, int to, Cap limit){
+    const size_t NONE = (size_t)-1;
+    Cap ans = 0;
+    vector<size_t> parentArc(net.n);
+    vi q;
+    while(ans < limit){
+      fill(parentArc.begin(), parentArc.end(), NONE);
+      q.assign(1,from);
+      for(size_t i = 0; i < q.size() && parentArc[to] == NONE; i++){
+	int u = q[i];
+	for(size_t j = net.start[u]; j < net.start[u+1]; j++){
+	  size_t a = net.arcsOf[j];
+	  int v = net.head[a];
+	  if (v != from && parentArc[v] == NONE && hasRoom(net.res[a])) {
+	    parentArc[v] = a;
+	    q.push_back(v);
+	  }
+	}
+      }
+      if (parentArc[to] == NONE) { break; }
+
+      Cap f = limit - ans;
+      for(int v = to; v != from; v = net.tail(parentArc[v]))
+	{ f = min(f, net.res[parentArc[v]]); }
+      for(int v = to; v != from; v = net.tail(parentArc[v])){
+	net.res[parentArc[v]] -= f;
+	net.res[parentArc[v]^1] += f;
+      }
+      ans += f;
+    }
+    return ans;
+  }
+
+  void reindex(){
+    if (dirty) {
+      net.index();
+      dirty = false;
+    }
+  }
+
+public:
+  IncrementalFlow(int n, int source, int sink)
+    : net(n), source(source), sink(sink), value(0), dirty(true),
+      sourceSide(n,false), cutStale(true) {}
+
+  //returns the arc id of u->v (see FlowNetwork::addEdge)
+  size_t addEdge(int u, int v, Cap c, bool undirected = false){
+    dirty = true;
+    cutStale = true;
+    return net.addEdge(u, v, c, undirected);
+  }
+
+  //sets the capacity of arc a alone (change both arcs of an undirected edge)
+  //if a carries more than c, the surplus is rerouted around a, and
+  //whatever can't be rerouted is cancelled back to the source and sink
+  void setCapacity(size_t a, Cap c){
+    reindex();
+    cutStale = true;
+    Cap f = net.flow(a);
+
+    if (c >= f) {
+      net.res[a] = c - f;
+      net.cap[a] = c;
+      return;
+    }
+
+    //cut the flow on a down to c: its tail now has d units too many
+    //coming in, and its head d units too few
+    Cap d = f - c;
+    int u = net.tail(a), v = net.head[a];
+    net.cap[a] = c;
+    net.res[a] = 0;
+    net.res[a^1] = net.cap[a^1] + c;
+
+    Cap rest = d - augment(u, v, d);
+    if (!hasRoom(rest)) { return; }
+    if (u != source) { augment(u, source, rest); }
+    if (v != sink) { augment(sink, v, rest); }
+    value -= rest;
+  }
+
+  void addCapacity(size_t a, Cap delta){ setCapacity(a, net.cap[a] + delta); }
+
+  //brings the flow back to a maximum; returns its value
+  Cap solve(){
+    reindex();
+    value += dinic(net, source, sink);
+    net.reachable(source, sourceSide);
+    cutStale = false;
+    return value;
+  }
+
+  Cap flowValue() const { return value; }
+
+  Cap flow(size_t a) const { return net.flow(a); }
+
+  const FlowNetwork<Cap>& residual() const { return net; }
+
+  //The cut queries below need solve() to have run since the last
+  //addEdge/setCapacity; otherwise there is no current cut to report
+
+  //true if u is on the source side of the min cut
+  bool onSourceSide(int u) const {
+    assert(!cutStale && "call solve() first");
+    return sourceSide[u];
+  }
+
+  //arcs of the min cut
+  void minCut(vector<size_t>& cut) const {
+    assert(!cutStale && "call solve() first");
+    for(size_t a = 0; a < net.head.size(); a++){
+      if (sourceSide[net.tail(a)] && !sourceSide[net.head[a]] && net.cap[a] > 0)
+	{ cut.push_back(a); }
+    }
+  }
+};
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+using namespace std;
+
+#include "maxFlow.cpp"
+
+//Times EdmondsKarp, Dinic and PushRelabel on random layered networks
+//with int, long long and double capacities, and min-cost flow on
+//smaller networks with costs
+//usage: maxFlowBench [layers width degree maxCapacity]
+
+//random layered network: source -> layers of width w -> sink,
+//each node with deg arcs into the next layer; with maxCost the arcs
+//between layers also get unit costs in [1,maxCost]
+template <typename Cap>
+FlowNetwork<Cap> layeredNetwork(int layers, int w, int deg, int maxCap,
+				unsigned seed, int maxCost = 0){
+  mt19937 rng(seed);
+  int n = layers*w + 2;
+  int source = n-2, sink = n-1;
+  FlowNetwork<Cap> net(n);
+  for(int i = 0; i < w; i++){
+    net.addEdge(source, i, Cap(1 + rng()%maxCap));
+    net.addEdge((layers-1)*w + i, sink, Cap(1 + rng()%maxCap));
+  }
+  for(int l = 0; l+1 < layers; l++){
+    for(int i = 0; i < w; i++){
+      for(int k = 0; k < deg; k++){
+	int v = (l+1)*w + rng()%w;
+	size_t a = net.addEdge(l*w + i, v, Cap(1 + rng()%maxCap));
+	if (maxCost) {
+	  net.cost[a] = 1 + rng()%maxCost;
+	  net.cost[a^1] = -net.cost[a];
+	}
+      }
+    }
+  }
+  net.index();
+  return net;
+}
+
+template <typename Algorithm, typename Cap>
+Cap timeFlow(const char* name, const FlowNetwork<Cap>& original){
+  FlowNetwork<Cap> net = original;
+  auto start = chrono::steady_clock::now();
+  Cap f = maxFlow<Algorithm>(net.n-2, net.n-1, net);
+  chrono::duration<double> t = chrono::steady_clock::now() - start;
+  cout << name << ": flow " << f << " in " << t.count() << "s" << endl;
+  return f;
+}
+
+//true if the residual network of net has a negative-cost cycle, i.e.
+//its flow is not of minimum cost (Bellman-Ford from a virtual root)
+template <typename Cap>
+bool negativeResidualCycle(const FlowNetwork<Cap>& net){
+  vll dist(net.n, 0);
+  for(int round = 0; round < net.n; round++){
+    bool changed = false;
+    for(size_t a = 0; a < net.head.size(); a++){
+      if (!hasRoom(net.res[a])) { continue; }
+      ll d = dist[net.tail(a)] + net.cost[a];
+      if (d < dist[net.head[a]]) {
+	dist[net.head[a]] = d;
+	changed = true;
+      }
+    }
+    if (!changed) { return false; }
+  }
+  return true;
+}
+
+//runs minCostFlow on a copy of original; net gets the solved copy
+template <typename Cap>
+pair<Cap, decltype(Cap()*(ll)0)>
+timeMinCostFlow(const char* name, const FlowNetwork<Cap>& original,
+		FlowNetwork<Cap>& net){
+  net = original;
+  auto start = chrono::steady_clock::now();
+  auto fc = minCostFlow(net, net.n-2, net.n-1);
+  chrono::duration<double> t = chrono::steady_clock::now() - start;
+  cout << name << ": flow " << fc.first << " at cost " << fc.second
+       << " in " << t.count() << "s" << endl;
+  return fc;
+}
+
+template <typename Cap>
+void compareFlows(const char* type, int layers, int w, int deg, int maxCap){
+  FlowNetwork<Cap> net = layeredNetwork<Cap>(layers, w, deg, maxCap, 1);
+  cout << type << ", " << net.n << " nodes, " << net.head.size()/2
+       << " arcs, capacities up to " << maxCap << endl;
+  timeFlow<EdmondsKarp>("  edmonds-karp", net);
+  timeFlow<Dinic>("  dinic", net);
+  timeFlow<PushRelabel>("  push-relabel", net);
+}
+
+//min-cost flow is much slower (one dijkstra per augmenting path), so
+//it gets its own, smaller network
+//Checks that it sends dinic's (maximum) flow and leaves no negative
+//residual cycle, i.e. that its cost is minimal; returns its cost, or
+//-1 on a failed check
+template <typename Cap>
+ll compareCostFlows(const char* type, int layers, int w, int deg,
+		    int maxCap, int maxCost){
+  FlowNetwork<Cap> net = layeredNetwork<Cap>(layers, w, deg, maxCap, 1, maxCost);
+  cout << type << ", " << net.n << " nodes, " << net.head.size()/2
+       << " arcs, capacities up to " << maxCap << ", costs up to "
+       << maxCost << endl;
+  Cap f = timeFlow<Dinic>("  dinic", net);
+  FlowNetwork<Cap> solved;
+  auto fc = timeMinCostFlow("  min-cost flow", net, solved);
+
+  bool ok = true;
+  if (fc.first != f) {
+    cout << "  FAILED: min-cost flow sent " << fc.first << ", max flow is "
+	 << f << endl;
+    ok = false;
+  }
+  if (negativeResidualCycle(solved)) {
+    cout << "  FAILED: residual network has a negative-cost cycle" << endl;
+    ok = false;
+  }
+  return ok ? (ll)fc.second : -1;
+}
+
+int main(int argc, char** argv){
+  int layers = 20, w = 500, deg = 4, maxCap = 100;
+  if (argc == 5) {
+    layers = atoi(argv[1]);
+    w = atoi(argv[2]);
+    deg = atoi(argv[3]);
+    maxCap = atoi(argv[4]);
+  }
+
+  compareFlows<int>("int", layers, w, deg, maxCap);
+  compareFlows<ll>("long long", layers, w, deg, maxCap);
+  compareFlows<double>("double", layers, w, deg, maxCap);
+  compareFlows<int>("unit int", layers, w, deg, 1);
+
+  //integral capacities, so both types must reach the same cost
+  ll costInt = compareCostFlows<int>("int", layers, w/10, deg, maxCap, 100);
+  ll costDouble = compareCostFlows<double>("double", layers, w/10, deg, maxCap, 100);
+  bool ok = costInt >= 0 && costDouble >= 0 && costInt == costDouble;
+  cout << "min-cost flow check: " << (ok ? "ok" : "FAILED") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*Thread helpers shared by the parallel snippets*/
+//Include-only: files that build with it #include "parallel.cpp"
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+//0 threads = one per core
+int numThreads(int threads){
+  if (threads > 0) { return threads; }
+  int hw = thread::hardware_concurrency();
+  return hw ? hw : 1;
+}
+
+//splits [0,n) into one contiguous block per thread
+//and runs f(lo, hi, threadId) on each block concurrently
+template <typename F>
+void parallelBlocks(int threads, size_t n, F f){
+  vector<thread> pool;
+  for(int t = 0; t < threads; t++){
+    size_t lo = n*t/threads;
+    size_t hi = n*(t+1)/threads;
+    pool.emplace_back(f, lo, hi, t);
+  }
+  for(auto& th: pool) { th.join(); }
+}
+
+//Fixed set of worker threads, kept alive between parallel loops
+//so that many small batches don't each pay for thread creation
+class ThreadPool{
+private:
+  vector<thread> workers;
+  mutex m;
+  condition_variable wake, finished;
+  function<void(int)> job;
+  unsigned long long round;
+  int running;
+  bool stop;
+
+  void work(int id){
+    unsigned long long seen = 0;
+    unique_lock<mutex> lk(m);
+    while(true){
+      wake.wait(lk, [&]{ return stop || round != seen; });
+      if (stop) { return; }
+      seen = round;
+
+      lk.unlock();
+      job(id);
+      lk.lock();
+
+      if (--running == 0) { finished.notify_all(); }
+    }
+  }
+
+public:
+  ThreadPool(int threads = 0) : round(0), running(0), stop(false) {
+    threads = numThreads(threads);
+    for(int t = 0; t < threads; t++) {
+      workers.emplace_back(&ThreadPool::work, this, t);
+    }
+  }
+
+  ~ThreadPool(){
+    {
+      lock_guard<mutex> lk(m);
+      stop = true;
+    }
+    wake.notify_all();
+    for(auto& th: workers) { th.join(); }
+  }
+
+  int size() const { return workers.size(); }
+
+  //runs f(threadId) once on every worker and waits for all of them
+  void runAll(function<void(int)> f){
+    unique_lock<mutex> lk(m);
+    job = f;
+    running = workers.size();
+    round++;
+    wake.notify_all();
+    finished.wait(lk, [&]{ return running == 0; });
+  }
+};
+
+//sorts [first,last): each thread sorts one block, then neighbouring
+//blocks are merged pairwise, the pairs of each round in parallel
+template <typename It, typename Cmp>
+void parallelSort(It first, It last, int threads, Cmp cmp){
+  size_t n = last-first;
+  if (threads <= 1 || n < 2*(size_t)threads) {
+    sort(first, last, cmp);
+    return;
+  }
+
+  vector<size_t> bounds(threads+1);
+  for(int t = 0; t <= threads; t++) { bounds[t] = n*t/threads; }
+
+  parallelBlocks(threads, threads, [&](size_t lo, size_t hi, int){
+      for(size_t b = lo; b < hi; b++)
+	{ sort(first+bounds[b], first+bounds[b+1], cmp); }
+    });
+
+  for(size_t width = 1; width < (size_t)threads; width *= 2){
+    size_t pairs = (threads + 2*width - 1) / (2*width);
+    parallelBlocks(min<size_t>(threads, pairs), pairs,
+		   [&](size_t lo, size_t hi, int){
+		     for(size_t p = lo; p < hi; p++){
+		       size_t l = p*2*width;
+		       size_t m = min<size_t>(l+width, threads);
+		       size_t r = min<size_t>(l+2*width, threads);
+		       if (m < r) {
+			 inplace_merge(first+bounds[l], first+bounds[m],
+				       first+bounds[r], cmp);
+		       }
+		     }
+		   });
+  }
+}
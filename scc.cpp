@@ -1,6 +1,7 @@
 
 //Based on NYU codebook
-void tarjanRec (AdjacencyList& adj, int i,
+template <typename Graph>
+void tarjanRec (Graph& adj, int i,
 		vi& visited, vi& low, int& t,
 		stack<int>& s,
 		vi& sccNum, int& scc) {
@@ -28,7 +29,9 @@ void tarjanRec (AdjacencyList& adj, int i,
 
 //returns the number of connected components
 //sccNum maps node to scc (the "group's number")
-int tarjan(AdjacencyList& adj, vi& sccNum){
+//Graph is an AdjacencyList or a CSRGraph
+template <typename Graph>
+int tarjan(Graph& adj, vi& sccNum){
   size_t n = adj.size();
 
   int t = 0;
@@ -40,3 +43,271 @@ int tarjan(AdjacencyList& adj, vi& sccNum){
 
   return scc;
 }
+
+//Pearce's space-efficient variant, iterative so long chains can't
+//overflow the call stack
+//sccNum doubles as rindex (visit order, then low-link, then component);
+//the only other per-node state is one "is root" bit
+//components are numbered exactly as tarjan() numbers them
+template <typename Graph>
+int tarjanIter(Graph& adj, vi& sccNum){
+  typedef decltype(adj[0].begin()) Iter;
+  struct Frame{
+    int v;
+    Iter it, end;
+  };
+
+  int n = adj.size();
+  vi& rindex = sccNum;
+  rindex.assign(n,0);
+  vector<bool> root(n);
+
+  //both stacks hold each node at most once
+  vector<Frame> frames(n);
+  vi s(n);
+  int depth = 0, top = 0;
+
+  int index = 1, c = n-1;
+
+  for(int start = 0; start < n; start++){
+    if (rindex[start]) { continue; }
+
+    rindex[start] = index++;
+    root[start] = true;
+    frames[depth++] = {start, adj[start].begin(), adj[start].end()};
+
+    while(depth){
+      Frame& f = frames[depth-1];
+      int v = f.v;
+
+      if (f.it != f.end) {
+	int w = (*f.it).first;
+
+	//descend, and revisit this edge once w is done
+	if (rindex[w] == 0) {
+	  rindex[w] = index++;
+	  root[w] = true;
+	  frames[depth++] = {w, adj[w].begin(), adj[w].end()};
+	  continue;
+	}
+
+	if (rindex[w] < rindex[v]) {
+	  rindex[v] = rindex[w];
+	  root[v] = false;
+	}
+	++f.it;
+	continue;
+      }
+
+      depth--;
+
+      if (root[v]) {
+	//pop v's component and give it id c
+	index--;
+	while(top && rindex[v] <= rindex[s[top-1]]){
+	  rindex[s[--top]] = c;
+	  index--;
+	}
+	rindex[v] = c;
+	c--;
+      }
+
+      else { s[top++] = v; }
+    }
+  }
+
+  //ids were handed out from n-1 downwards
+  for(int v = 0; v < n; v++) { sccNum[v] = n-1-rindex[v]; }
+
+  return n-1-c;
+}
+
+//Parallel SCC: trim, then forward-backward on a pool of tasks
+//Trim peels nodes with no live in- or out-edges (each is its own SCC).
+//Each FW-BW task owns the nodes of one color: the nodes reached both
+//forwards and backwards from a pivot form an SCC, and the three
+//leftover sets become new tasks. Small tasks fall back to tarjanIter.
+//sccNum groups nodes exactly like tarjan(), but ids are not in its order
+//returns the number of strongly connected components
+template <typename Graph>
+int parallelScc(Graph& adj, vi& sccNum, int threads = 0,
+		size_t smallTask = 4096){
+  int n = adj.size();
+  threads = numThreads(threads);
+  sccNum.assign(n,-1);
+
+  //reverse graph
+  vector<pair<int,int> > revEdges;
+  for(int u = 0; u < n; u++){
+    for(auto p: adj[u]) { revEdges.push_back({p.first,u}); }
+  }
+  CSRGraph rev(n, revEdges);
+  revEdges = vector<pair<int,int> >();
+
+  atomic<int> nextId(0);
+
+  //trim: count degrees, then peel zero-degree nodes wave by wave
+  vector<atomic<int> > indeg(n), outdeg(n);
+  vector<atomic<char> > removed(n);
+  parallelBlocks(threads, n, [&](size_t lo, size_t hi, int){
+      for(size_t u = lo; u < hi; u++){
+	indeg[u] = rev.degree(u);
+	outdeg[u] = adj[u].size();
+	removed[u] = 0;
+      }
+    });
+
+  auto claim = [&](int u){
+    if (removed[u].exchange(1)) { return false; }
+    sccNum[u] = nextId++;
+    return true;
+  };
+
+  vector<vi> frontier(threads);
+  parallelBlocks(threads, n, [&](size_t lo, size_t hi, int t){
+      for(size_t u = lo; u < hi; u++){
+	if ((indeg[u] == 0 || outdeg[u] == 0) && claim(u))
+	  { frontier[t].push_back(u); }
+      }
+    });
+
+  while(true){
+    vi wave;
+    for(auto& f: frontier) {
+      wave.insert(wave.end(), f.begin(), f.end());
+      f.clear();
+    }
+    if (wave.empty()) { break; }
+
+    parallelBlocks(threads, wave.size(), [&](size_t lo, size_t hi, int t){
+	for(size_t i = lo; i < hi; i++){
+	  int u = wave[i];
+	  for(auto p: adj[u]){
+	    int v = p.first;
+	    if (--indeg[v] == 0 && claim(v)) { frontier[t].push_back(v); }
+	  }
+	  for(auto p: rev[u]){
+	    int v = p.first;
+	    if (--outdeg[v] == 0 && claim(v)) { frontier[t].push_back(v); }
+	  }
+	}
+      });
+  }
+
+  //FW-BW; color -1 means the node already has its SCC
+  vector<atomic<int> > color(n);
+  vi first;
+  for(int u = 0; u < n; u++){
+    color[u].store(removed[u] ? -1 : 0, memory_order_relaxed);
+    if (!removed[u]) { first.push_back(u); }
+  }
+  atomic<int> nextColor(1);
+
+  //per-node scratch, only touched by the task owning the node
+  vector<char> fw(n,0), bw(n,0);
+  vi local(n);
+
+  mutex m;
+  condition_variable cv;
+  vector<vi> tasks;
+  int active = 0;
+  if (!first.empty()) { tasks.push_back(move(first)); }
+
+  auto sameColor = [&](int v, int c){
+    return color[v].load(memory_order_relaxed) == c;
+  };
+
+  //marks every node of color c reachable from pivot in g
+  auto reach = [&](auto& g, int pivot, int c, vector<char>& mark, vi& s){
+    mark[pivot] = 1;
+    s.push_back(pivot);
+    while(!s.empty()){
+      int u = s.back();
+      s.pop_back();
+      for(auto p: g[u]){
+	int v = p.first;
+	if (sameColor(v,c) && !mark[v]) {
+	  mark[v] = 1;
+	  s.push_back(v);
+	}
+      }
+    }
+  };
+
+  auto solve = [&](vi& nodes, vector<vi>& out){
+    int c = color[nodes[0]].load(memory_order_relaxed);
+
+    if (nodes.size() <= smallTask) {
+      int k = nodes.size();
+      for(int i = 0; i < k; i++) { local[nodes[i]] = i; }
+      AdjacencyList sub(k);
+      for(int i = 0; i < k; i++){
+	for(auto p: adj[nodes[i]]){
+	  if (sameColor(p.first,c)) { sub[i].push_back({local[p.first],1}); }
+	}
+      }
+      vi ids;
+      int base = nextId.fetch_add(tarjanIter(sub,ids));
+      for(int i = 0; i < k; i++){
+	sccNum[nodes[i]] = base + ids[i];
+	color[nodes[i]].store(-1, memory_order_relaxed);
+      }
+      return;
+    }
+
+    //pivot at a pseudo-random position: nodes[0] is the lowest id, which
+    //on path-like graphs peels one small SCC per task (quadratic)
+    unsigned long long h = (c+1) * 0x9E3779B97F4A7C15ull;
+    int pivot = nodes[(h ^ (h >> 29)) % nodes.size()];
+
+    vi s;
+    reach(adj, pivot, c, fw, s);
+    reach(rev, pivot, c, bw, s);
+
+    int id = nextId++;
+    vi fwOnly, bwOnly, rest;
+    for(int v: nodes){
+      if (fw[v] && bw[v]) { sccNum[v] = id; }
+      else if (fw[v]) { fwOnly.push_back(v); }
+      else if (bw[v]) { bwOnly.push_back(v); }
+      else { rest.push_back(v); }
+    }
+    for(int v: nodes){
+      if (fw[v] && bw[v]) { color[v].store(-1, memory_order_relaxed); }
+      fw[v] = bw[v] = 0;
+    }
+    for(vi* piece: {&fwOnly, &bwOnly, &rest}){
+      if (piece->empty()) { continue; }
+      int pc = nextColor++;
+      for(int v: *piece) { color[v].store(pc, memory_order_relaxed); }
+      out.push_back(move(*piece));
+    }
+  };
+
+  auto worker = [&](){
+    unique_lock<mutex> lk(m);
+    while(true){
+      cv.wait(lk, [&]{ return !tasks.empty() || active == 0; });
+      if (tasks.empty()) { return; }
+
+      vi nodes = move(tasks.back());
+      tasks.pop_back();
+      active++;
+      lk.unlock();
+
+      vector<vi> out;
+      solve(nodes, out);
+
+      lk.lock();
+      active--;
+      for(auto& o: out) { tasks.push_back(move(o)); }
+      if (!out.empty() || active == 0) { cv.notify_all(); }
+    }
+  };
+
+  vector<thread> pool;
+  for(int t = 0; t < threads; t++) { pool.emplace_back(worker); }
+  for(auto& th: pool) { th.join(); }
+
+  return nextId;
+}
@@ -0,0 +1,180 @@
+#include <vector>
+#include <stack>
+#include <atomic>
+#include <random>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <pthread.h>
+
+using namespace std;
+
+#define vi vector<int>
+#define AdjacencyList vector<vector<pair<int,int> > >
+#define repeat(i,n) for(size_t i = 0; i < (n); i++)
+
+#include "parallel.cpp"
+#include "csrGraph.cpp"
+#include "scc.cpp"
+
+//Differential test: parallelScc must group nodes exactly as tarjan()
+//does, on random graphs of every density, with any thread count and
+//task cutoff; tarjanIter must also match tarjan's numbering.
+//Then a throughput benchmark of all three on deep random and
+//path-like graphs.
+
+//true if a and b put the same nodes together (ids may differ)
+bool samePartition(const vi& a, const vi& b){
+  size_t n = a.size();
+  if (b.size() != n) { return false; }
+  vi ab(n,-1), ba(n,-1);
+  for(size_t u = 0; u < n; u++){
+    if (a[u] < 0 || b[u] < 0 || a[u] >= (int)n || b[u] >= (int)n) { return false; }
+    if (ab[a[u]] < 0) { ab[a[u]] = b[u]; }
+    if (ba[b[u]] < 0) { ba[b[u]] = a[u]; }
+    if (ab[a[u]] != b[u] || ba[b[u]] != a[u]) { return false; }
+  }
+  return true;
+}
+
+template <typename Graph>
+bool check(Graph& adj, int threads, size_t smallTask){
+  size_t n = adj.size();
+  vi expected(n), iter, par;
+  int count = tarjan(adj, expected);
+  if (tarjanIter(adj, iter) != count || iter != expected) { return false; }
+  return parallelScc(adj, par, threads, smallTask) == count &&
+    samePartition(expected, par);
+}
+
+//runs f on a thread with a 1 GB stack, so recursive tarjan() survives
+//DFS paths millions of nodes deep
+template <typename F>
+void onBigStack(F f){
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, (size_t)1 << 30);
+  pthread_t th;
+  pthread_create(&th, &attr, [](void* p) -> void* { (*(F*)p)(); return 0; }, &f);
+  pthread_join(th, 0);
+  pthread_attr_destroy(&attr);
+}
+
+double seconds(chrono::steady_clock::time_point start){
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//throughput of tarjan, tarjanIter and parallelScc on one graph
+void benchmark(const char* family, CSRGraph& g){
+  vi a(g.size()), b, c;
+  int sa = 0, sb, sc;
+  double ta, tb, tc;
+
+  auto start = chrono::steady_clock::now();
+  onBigStack([&]{ sa = tarjan(g, a); });
+  ta = seconds(start);
+
+  start = chrono::steady_clock::now();
+  sb = tarjanIter(g, b);
+  tb = seconds(start);
+
+  start = chrono::steady_clock::now();
+  sc = parallelScc(g, c);
+  tc = seconds(start);
+
+  double edges = g.numEdges();
+  printf("%s, %zu nodes, %zu edges, %d SCCs%s\n", family, g.size(),
+	 g.numEdges(), sa, sa == sb && sa == sc ? "" : "  (MISMATCH)");
+  printf("  tarjan (recursive) %.3fs  %.1f Medges/s\n", ta, edges/ta/1e6);
+  printf("  tarjanIter         %.3fs  %.1f Medges/s\n", tb, edges/tb/1e6);
+  printf("  parallelScc        %.3fs  %.1f Medges/s\n", tc, edges/tc/1e6);
+}
+
+//usage: sccTest [nodes]   (size of the benchmark graphs)
+int main(int argc, char** argv){
+  mt19937 rng(3);
+  int failures = 0, runs = 0;
+
+  for(int it = 0; it < 2000; it++){
+    int n = 1 + rng()%200;
+    int m = rng()%(4*n);
+    //random edges, and half the time one long cycle through a random
+    //order so that big components show up
+    AdjacencyList adj(n);
+    vector<pair<int,int> > edges;
+    for(int i = 0; i < m; i++){
+      int u = rng()%n, v = rng()%n;
+      edges.push_back({u,v});
+      adj[u].push_back({v,1});
+    }
+    if (rng()%2) {
+      vi order(n);
+      for(int i = 0; i < n; i++) { order[i] = i; }
+      shuffle(order.begin(), order.end(), rng);
+      int len = 1 + rng()%n;
+      for(int i = 0; i < len; i++){
+	int u = order[i], v = order[(i+1)%len];
+	edges.push_back({u,v});
+	adj[u].push_back({v,1});
+      }
+    }
+    CSRGraph csr(n, edges);
+
+    int threads = 1 + rng()%8;
+    size_t smallTask = rng()%2 ? 1 + rng()%16 : 4096;
+    runs += 2;
+    if (!check(adj, threads, smallTask)) {
+      printf("AdjacencyList: n=%d m=%zu threads=%d smallTask=%zu\n",
+	     n, edges.size(), threads, smallTask);
+      failures++;
+    }
+    if (!check(csr, threads, smallTask)) {
+      printf("CSRGraph: n=%d m=%zu threads=%d smallTask=%zu\n",
+	     n, edges.size(), threads, smallTask);
+      failures++;
+    }
+  }
+
+  //large enough for the FW-BW tasks to run at the default cutoff
+  for(int n: {20000, 100000}){
+    vector<pair<int,int> > edges;
+    for(int i = 0; i < 2*n; i++) { edges.push_back({(int)(rng()%n), (int)(rng()%n)}); }
+    CSRGraph csr(n, edges);
+    for(int threads: {1, 4}){
+      runs++;
+      if (!check(csr, threads, 4096)) {
+	printf("CSRGraph: n=%d m=%zu threads=%d\n", n, edges.size(), threads);
+	failures++;
+      }
+    }
+  }
+
+  printf("%d/%d graphs agree\n", runs-failures, runs);
+
+  int n = argc == 2 ? atoi(argv[1]) : 2000000;
+
+  //deep random: sparse random edges plus one cycle through every node
+  //in random order, so the DFS goes n deep and there is one giant SCC
+  vector<pair<int,int> > edges;
+  vi order(n);
+  for(int i = 0; i < n; i++) { order[i] = i; }
+  shuffle(order.begin(), order.end(), rng);
+  for(int i = 0; i < n; i++) { edges.push_back({order[i], order[(i+1)%n]}); }
+  for(int i = 0; i < 2*n; i++) { edges.push_back({(int)(rng()%n), (int)(rng()%n)}); }
+  CSRGraph deep(n, edges);
+  benchmark("deep random", deep);
+
+  //path-like: a path 0 -> 1 -> ... with short back edges, so SCCs are
+  //small runs of the path and the DFS is still n deep
+  edges.clear();
+  for(int i = 0; i+1 < n; i++) { edges.push_back({i,i+1}); }
+  for(int i = 0; i < n/4; i++){
+    int u = rng()%n;
+    edges.push_back({u, max(0, u - 1 - (int)(rng()%8))});
+  }
+  CSRGraph path(n, edges);
+  benchmark("path-like", path);
+
+  return failures ? 1 : 0;
+}
@@ -14,16 +14,20 @@
     Let Q = substrings that appear multiple times and in >k input strings
     this method fills vector with longest such Q
     returns length of such strings
+
+  SuffixArray answers the same two queries (same results) from a suffix
+  array and LCP array, at about 9 bytes per input character
 */
+//Include-only: files that build with it #include "suffixTree.cpp"
+#pragma once
 
-#include <map>
-#include <set>
-#include <stack>
 #include <string>
 #include <limits>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <cstdint>
 
 using namespace std;
 
@@ -44,120 +48,144 @@ char ithDelim(int i){
 
 struct SuffixTree {
 
-  bool isDelim(char c){
+  bool isDelim(char c) const {
     return (c < LOWER) || (c > UPPER);
   }
 
-  static const int INF = 1<<30;
+  static constexpr int INF = 1<<30;
+  static constexpr uint32_t NONE = UINT32_MAX;
+  static constexpr uint32_t ROOT = 0, SENTINEL = 1;
   int last;
   string str;
 
-  struct Node;
-  struct Edge {
-    int a,b;
-    Node *begin,*end;
-    SuffixTree* tree;
-    Edge(int a, int b, Node *end, SuffixTree* tree)
-      : a(a), b(b), begin(NULL), end(end), tree(tree) {}
-    char getFirst() const { return tree->str[a]; }
-    int size() const { return min(tree->last,b)-a+1; }
-    friend ostream& operator<<(ostream& out, Edge& e);
-  };
-
+  //All nodes live in one arena and refer to each other by index.
+  //A node also stores the edge leading into it: str[ea..eb] from
+  //parent (eb = INF while the leaf is still growing).
+  //a..b is where the node's whole path label occurs (set by setPrefix)
   struct Node {
-    Edge* inEdge;
-    map<char,Edge*> edges;
-    Node* suffix;
-    int a,b,leavesBelow,distinctDelims;
-    SuffixTree* tree;
-    Node(SuffixTree* tree)
-      : tree(tree), leavesBelow(0), distinctDelims(0), inEdge(NULL) {}
-
-    void add(Edge* e) { edges[e->getFirst()] = e; }
-    Edge* operator[](char c) { return edges[c]; }
-    int numChildren() { return edges.size(); }
-    friend ostream& operator<<(ostream& out, Node&);
+    int a,b,ea,eb;
+    uint32_t parent,suffix;
+    int leavesBelow,distinctDelims;
   };
-    
-  Node *root, *sentinel;
 
-  Node* getRoot() { return root; }
+  vector<Node> nodes;
+
+  //While building, every node's children sit in one shared hash table
+  //keyed by (node, first char of edge). Once built they are moved to
+  //kids[kidStart[v]..kidStart[v+1]), sorted by first char (the order
+  //a map<char,...> would give), and the table is dropped.
+  vector<uint64_t> slotKey;
+  vector<uint32_t> slotChild;
+  int slotBits;
+  vector<uint32_t> kidStart, kids;
+
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+  uint32_t getRoot() const { return ROOT; }
   const string& getStr() const { return str; }
-  
-  void setPrefix(Node* n, Edge* e, int len) {
-    map<char,Edge*>::iterator it = n->edges.begin();
-    for (; it != n->edges.end(); ++it) {
-      Edge *edge = it->second;
-      setPrefix(edge->end,edge,len+min(edge->b,last)-edge->a+1);
-    }
 
-    if (e) {
-      n->b = min(e->b,last);
-      n->a = n->b - len + 1;
-    }
+  static uint64_t key(uint32_t v, char c) {
+    return (uint64_t)v << 8 | (unsigned char)c;
+  }
+
+  size_t slotOf(uint64_t k) const {
+    size_t i = (k * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits);
+    size_t mask = slotKey.size() - 1;
+    while (slotKey[i] != k && slotKey[i] != EMPTY) { i = (i+1) & mask; }
+    return i;
+  }
+
+  uint32_t child(uint32_t v, char c) const {
+    size_t i = slotOf(key(v,c));
+    return slotKey[i] == EMPTY ? NONE : slotChild[i];
+  }
 
-    else {
-      n->a = 0;
-      n->b = -1;
+  void setChild(uint32_t v, char c, uint32_t w) {
+    size_t i = slotOf(key(v,c));
+    slotKey[i] = key(v,c);
+    slotChild[i] = w;
+  }
+
+  uint32_t newNode(int ea, int eb) {
+    nodes.push_back({0,-1,ea,eb,NONE,NONE,0,0});
+    return nodes.size()-1;
+  }
+
+  int numChildren(uint32_t v) const { return kidStart[v+1] - kidStart[v]; }
+
+  //child of v whose edge starts with c, or NONE (once built)
+  uint32_t findChild(uint32_t v, char c) const {
+    for (uint32_t i = kidStart[v]; i < kidStart[v+1]; i++) {
+      if (str[nodes[kids[i]].ea] == c) { return kids[i]; }
     }
+    return NONE;
   }
 
-  Node* testAndSplit(Node* s, int k, int p, char c) {
+  int edgeSize(uint32_t v) const { return min(last,nodes[v].eb)-nodes[v].ea+1; }
+
+  uint32_t testAndSplit(uint32_t s, int k, int p, char c) {
     if (k > p) {
-      return s == sentinel ? NULL : (*s)[c] == NULL ? s : NULL;
+      return s == SENTINEL ? NONE : child(s,c) == NONE ? s : NONE;
     }
 
-    Edge* e = (*s)[str[k]];
-    if (c == str[e->a+p-k+1]) return NULL;
-    Node* r = new Node(this);
-    Edge* re = new Edge(e->a+p-k+1,e->b,e->end,this);
-    r->add(re);
-    Edge* se = new Edge(e->a,e->a+p-k,r,this);
-    s->add(se);
+    uint32_t e = child(s,str[k]);
+    int ea = nodes[e].ea;
+    if (c == str[ea+p-k+1]) return NONE;
+    uint32_t r = newNode(ea,ea+p-k);
+    nodes[e].ea = ea+p-k+1;
+    setChild(r,str[ea+p-k+1],e);
+    setChild(s,str[k],r);
     return r;
   }
 
-  Node* canonize(Node* s, int& k, int p) {
+  uint32_t canonize(uint32_t s, int& k, int p) {
     if (p < k) { return s; }
 
-    if (s == sentinel) {
-      s = root;
+    if (s == SENTINEL) {
+      s = ROOT;
       ++k;
       if (p < k) { return s; }
     }
 
-    Edge* e = (*s)[str[k]];
-    while (e->b - e->a <= p - k) {
-      k = k + e->b - e->a + 1;
-      s = e->end;
-      if (k <= p) e = (*s)[str[k]];
+    uint32_t e = child(s,str[k]);
+    while (nodes[e].eb - nodes[e].ea <= p - k) {
+      k = k + nodes[e].eb - nodes[e].ea + 1;
+      s = e;
+      if (k <= p) e = child(s,str[k]);
     }
 
     return s;
   }
 
-  Node* update(Node* s, int& k, int i) {
-    Node *oldr = root, *r = testAndSplit(s,k,i-1,str[i]);
-    while (r) {
-      Node* rp = new Node(this);
-      Edge* e = new Edge(i,INF,rp,this);
-      r->add(e);
-      if (oldr != root) { oldr->suffix = r; }
+  uint32_t update(uint32_t s, int& k, int i) {
+    uint32_t oldr = ROOT, r = testAndSplit(s,k,i-1,str[i]);
+    while (r != NONE) {
+      setChild(r,str[i],newNode(i,INF));
+      if (oldr != ROOT) { nodes[oldr].suffix = r; }
       oldr = r;
-      s = canonize(s->suffix,k,i-1);
-      r = testAndSplit(s,k,i-1,str[i]);	    
+      s = canonize(nodes[s].suffix,k,i-1);
+      r = testAndSplit(s,k,i-1,str[i]);
     }
 
-    if (oldr != root) { oldr->suffix = s; }
+    if (oldr != ROOT) { nodes[oldr].suffix = s; }
 
     return s;
   }
 
   void buildTree() {
-    root = new Node(this);
-    sentinel = new Node(this);
-    root->suffix = sentinel;
-    Node* s = root;
+    //at most 2n+2 nodes and 2n edges: reserve once, keep the table
+    //at most half full
+    size_t n = str.size();
+    nodes.reserve(2*n+2);
+    slotBits = 4;
+    while (((size_t)1 << slotBits) < 4*n+16) { slotBits++; }
+    slotKey.assign((size_t)1 << slotBits, EMPTY);
+    slotChild.resize(slotKey.size());
+
+    newNode(0,-1);
+    newNode(0,-1);
+    nodes[ROOT].suffix = SENTINEL;
+    uint32_t s = ROOT;
     int k = 0;
     last = -1;
     for (int i = 0; i < (int)str.size(); ++i) {
@@ -167,206 +195,438 @@ struct SuffixTree {
     }
   }
 
-  int fix(int x) const { return x == INF ? last : x; }
+  //moves children out of the hash table into sorted contiguous runs
+  void freeze() {
+    size_t count = nodes.size();
+    kidStart.assign(count+1,0);
+    for (uint64_t k: slotKey) {
+      if (k != EMPTY) { kidStart[(k >> 8) + 1]++; }
+    }
+    for (size_t v = 0; v < count; v++) { kidStart[v+1] += kidStart[v]; }
+
+    kids.resize(kidStart[count]);
+    vector<uint32_t> next(kidStart.begin(), kidStart.end()-1);
+    for (size_t i = 0; i < slotKey.size(); i++) {
+      if (slotKey[i] == EMPTY) { continue; }
+      uint32_t v = slotKey[i] >> 8;
+      kids[next[v]++] = slotChild[i];
+      nodes[slotChild[i]].parent = v;
+    }
 
-  friend ostream& operator<<(ostream& out, SuffixTree& t);
+    for (size_t v = 0; v < count; v++) {
+      sort(kids.begin()+kidStart[v], kids.begin()+kidStart[v+1],
+	   [&](uint32_t x, uint32_t y){ return str[nodes[x].ea] < str[nodes[y].ea]; });
+    }
 
-  ostream& prettyFormat(ostream& out, Node* n, int tab) const {
-    out << string(tab,' ') << "\"" << *n << "\"" << n->distinctDelims << endl;
-    map<char,Edge*>::iterator it = n->edges.begin();
+    vector<uint64_t>().swap(slotKey);
+    vector<uint32_t>().swap(slotChild);
+  }
 
-    for (; it != n->edges.end(); ++it) {
-      Edge* e = it->second;
+  //nodes in depth-first order, children in sorted order
+  vector<uint32_t> preorder() const {
+    vector<uint32_t> order, todo(1,ROOT);
+    order.reserve(nodes.size());
+    while (!todo.empty()) {
+      uint32_t v = todo.back();
+      todo.pop_back();
+      order.push_back(v);
+      for (uint32_t i = kidStart[v+1]; i > kidStart[v]; i--) { todo.push_back(kids[i-1]); }
+    }
+    return order;
+  }
+
+  void setPrefix(const vector<uint32_t>& order) {
+    nodes[ROOT].a = 0;
+    nodes[ROOT].b = -1;
+    for (uint32_t v: order) {
+      if (v == ROOT) { continue; }
+      Node& n = nodes[v];
+      const Node& p = nodes[n.parent];
+      int len = (p.b - p.a + 1) + min(n.eb,last) - n.ea + 1;
+      n.b = min(n.eb,last);
+      n.a = n.b - len + 1;
+    }
+  }
 
-      out << string(tab,' ') << it->first << " : "
-	   << *e << " = " << e->a << ',' << fix(e->b) << ',' << e->size() << endl;
+  int fix(int x) const { return x == INF ? last : x; }
+
+  friend ostream& operator<<(ostream& out, SuffixTree& t);
 
-      prettyFormat(out,e->end,tab+2);
+  //walks preorder() rather than recursing, so deep trees (e.g. a long
+  //run of one letter) can't overflow the call stack; each node is
+  //indented two spaces per level, and its edge line goes just above it
+  ostream& prettyFormat(ostream& out) const {
+    vector<int> tab(nodes.size(), 0);
+    for (uint32_t v: preorder()) {
+      const Node& n = nodes[v];
+      if (v != ROOT) {
+	int t = tab[n.parent];
+	tab[v] = t+2;
+	out << string(t,' ') << str[n.ea] << " : "
+	    << str.substr(n.ea,edgeSize(v)) << " = " << n.ea << ','
+	    << fix(n.eb) << ',' << edgeSize(v) << endl;
+      }
+      out << string(tab[v],' ') << "\"" << str.substr(n.a,min(n.b,last)-n.a+1)
+	  << "\"" << n.distinctDelims << endl;
     }
 
     return out;
   }
 
-  //number of leaves in subtree
-  //number of distinct delimiters
-  int postprocess(Node* n, set<char>& delims) {
-    for(auto p: n->edges){
-      //assign parent pointers
-      Edge* e = p.second;
-      Node* child = e->end;
-
-      child->inEdge = e;
-      e->begin = n;
-
-      //count number of leaves in subtree
-      set<char> childDelims;
-      n->leavesBelow += postprocess(child, childDelims);
-      for(auto c: childDelims) { delims.insert(c); }
-      
-    }
-
-    //leaf
-    if (n->numChildren() == 0) {
-      n->leavesBelow = 1;
-      
-      Edge* inEdge = n->inEdge;
-
-      for(int i = 0; i < inEdge->size(); i++){
-	if (isDelim(str[inEdge->a + i])) {
-	  inEdge->b = inEdge->a + i;
-	  n->b = inEdge->b;
-	  break;
-	}
+  //number of leaves in each subtree
+  //number of distinct delimiters in each subtree
+  //Leaf edges are cut back to their first delimiter. Leaves below a
+  //node are contiguous in depth-first order, so distinct delimiters
+  //per subtree are distinct values in a range, counted in one sweep
+  //with a Fenwick tree that keeps each delimiter at its latest leaf.
+  void postprocess(const vector<uint32_t>& order) {
+    int n = str.size();
+    vector<int> nextDelim(n+1,INF);
+    for (int i = n-1; i >= 0; i--) { nextDelim[i] = isDelim(str[i]) ? i : nextDelim[i+1]; }
+
+    vector<unsigned char> leafDelim;
+    vector<int> firstLeaf(nodes.size());
+    for (uint32_t v: order) {
+      firstLeaf[v] = leafDelim.size();
+      if (numChildren(v) || v == ROOT) { continue; }
+
+      Node& leaf = nodes[v];
+      if (nextDelim[leaf.ea] <= min(leaf.eb,last)) {
+	leaf.eb = nextDelim[leaf.ea];
+	leaf.b = leaf.eb;
       }
+      leaf.leavesBelow = 1;
+      leafDelim.push_back(str[leaf.ea + edgeSize(v) - 1]);
+    }
 
-      int index = inEdge->a + inEdge->size() - 1;
-      delims.insert(str[index]);
+    for (size_t i = order.size(); i-- > 1; ) {
+      uint32_t v = order[i];
+      nodes[nodes[v].parent].leavesBelow += nodes[v].leavesBelow;
     }
 
-    n->distinctDelims = delims.size();
+    //subtrees bucketed by their last leaf
+    int leaves = leafDelim.size();
+    vector<uint32_t> endStart(leaves+1,0), byEnd;
+    for (uint32_t v: order) {
+      if (nodes[v].leavesBelow) { endStart[firstLeaf[v] + nodes[v].leavesBelow]++; }
+    }
+    for (int i = 0; i < leaves; i++) { endStart[i+1] += endStart[i]; }
+    byEnd.resize(endStart[leaves]);
+    vector<uint32_t> next(endStart.begin(), endStart.end()-1);
+    for (uint32_t v: order) {
+      if (nodes[v].leavesBelow) { byEnd[next[firstLeaf[v] + nodes[v].leavesBelow - 1]++] = v; }
+    }
 
-    return n->leavesBelow;
+    vector<int> fenwick(leaves+1,0), latest(256,-1);
+    auto add = [&](int i, int d){
+      for (i++; i <= leaves; i += i & -i) { fenwick[i] += d; }
+    };
+    auto prefix = [&](int i){
+      int total = 0;
+      for (; i > 0; i -= i & -i) { total += fenwick[i]; }
+      return total;
+    };
+
+    for (int i = 0; i < leaves; i++) {
+      if (latest[leafDelim[i]] >= 0) { add(latest[leafDelim[i]], -1); }
+      add(i,1);
+      latest[leafDelim[i]] = i;
+
+      for (uint32_t j = endStart[i]; j < endStart[i+1]; j++) {
+	uint32_t v = byEnd[j];
+	nodes[v].distinctDelims = prefix(i+1) - prefix(firstLeaf[v]);
+      }
+    }
   }
 
   SuffixTree(const string& str) : str(str) {
     buildTree();
-    setPrefix(root,NULL,0);
-    set<char> delims;
-    postprocess(root,delims);
+    freeze();
+    vector<uint32_t> order = preorder();
+    setPrefix(order);
+    postprocess(order);
   }
 
-  void destroyNode(Node* n){
-    for(auto p: n->edges){
-      Edge* e = p.second;
-      destroyNode(e->end);
-      delete e;
-    }
+  //nodes and edges are freed with their arena, all at once
 
-    delete n;
-  }
-
-  ~SuffixTree(){
-    destroyNode(root);
-    delete sentinel;
-  }
+  int occurrences(const string& s){
+    if (s.empty()) { return 0; }
 
-  int occurrences(const string& s, int index, Node* n){
-    //cerr << "Called occurrences()" << endl;
-    if (n->numChildren() == 0) {
-      //cerr << "No children" << endl;
-      return 0;
-    }
-    if (n->edges.find(s[index]) == n->edges.end()) {
-      //cerr << "Cannot find " << s[index] << endl;
-      return 0;
-    }
+    uint32_t v = ROOT;
+    size_t index = 0;
+    while (true) {
+      if (numChildren(v) == 0) { return 0; }
+      uint32_t c = findChild(v,s[index]);
+      if (c == NONE) { return 0; }
 
-    Edge* e = n->edges[s[index]];
+      const Node& e = nodes[c];
+      for(int i = e.ea; i < e.ea+edgeSize(c); i++){
 
-    for(int i = e->a; i < e->a+e->size(); i++){
+	if (str[i] == s[index]) {
+	  index++;
+	  if (index == s.size()) { break; }
+	}
 
-      if (str[i] == s[index]) {
-	index++;
-	if (index == s.size()) { break; }
+	else { return 0; }
       }
 
-      else { return 0; }
+      if (index == s.size()) { return max(1,e.leavesBelow); }
+      v = c;
     }
-
-    if (index == s.size()) { return max(1,e->end->leavesBelow); }
-
-    return occurrences(s,index,e->end);
   }
 
-  int occurrences(const string& s){
-    return occurrences(s,0,root);
-  }
-  
-  void longestRepeat(Node* n, int size, int& length,
-		     vector<Node*>& ptrs, int threshold){
-    if (n != root
-	//repeats iff there are multiple leaves in the subtree
-	&& n->leavesBelow > 1
-	//longest
-	&& size >= length
-	//check if the number of input strings is above the specified threshold
-	&& n->distinctDelims > threshold
-	) {
-      if (size > length) {
-	length = size;
-	ptrs.clear();
+  int longestRepeat(vector<string>& longest, int threshold=0){
+    int length = 0;
+    vector<uint32_t> found;
+
+    for (uint32_t v: preorder()) {
+      const Node& n = nodes[v];
+      int size = n.b - n.a + 1;
+      if (v != ROOT
+	  //repeats iff there are multiple leaves in the subtree
+	  && n.leavesBelow > 1
+	  //longest
+	  && size >= length
+	  //check if the number of input strings is above the specified threshold
+	  && n.distinctDelims > threshold
+	  ) {
+	if (size > length) {
+	  length = size;
+	  found.clear();
+	}
+	found.push_back(v);
       }
-      ptrs.push_back(n);
-      
     }
 
-    for(auto p: n->edges){
-      Edge* e = p.second;
-      longestRepeat(e->end, size+e->size(), length, ptrs, threshold);
-    }
+    //an internal node's path label is str[a..b]
+    for (uint32_t v: found) { longest.push_back(str.substr(nodes[v].a,length)); }
 
+    return length;
   }
+  
+};
 
-  int longestRepeat(vector<string>& longest, int threshold=0){
-    int length = 0;
-    vector<Node*> ptrs;
+ostream& operator<<(ostream& out, SuffixTree& t)
+{ return t.prettyFormat(out); }
+
+
+//SA-IS (Nong, Zhang, Chan): suffix array of s[0..n) in linear time,
+//where every s[i] is in [0,upper]
+//LMS substrings are sorted by one round of induced sorting, named,
+//and if two share a name the reduced string is solved recursively;
+//a second induced sort then places every suffix
+template <typename T>
+vector<int> saIs(const T* s, int n, int upper){
+  vector<int> sa(n);
+  if (n == 0) { return sa; }
+  if (n == 1) { sa[0] = 0; return sa; }
+  if (n == 2) {
+    if (s[0] < s[1]) { sa[0] = 0; sa[1] = 1; }
+    else { sa[0] = 1; sa[1] = 0; }
+    return sa;
+  }
 
-    longestRepeat(root, 0, length, ptrs, threshold);
+  //S-type: suffix i is smaller than suffix i+1
+  vector<char> sType(n,0);
+  for (int i = n-2; i >= 0; i--) {
+    sType[i] = s[i] == s[i+1] ? sType[i+1] : s[i] < s[i+1];
+  }
 
-    //reconstruct by walking up to root
-    for (auto p: ptrs) {
-      Node* ptr = p;
-      string cur = "";
+  //bucket boundaries: L-types of c start at startL[c], S-types at startS[c]
+  vector<int> startL(upper+1,0), startS(upper+1,0);
+  for (int i = 0; i < n; i++) {
+    if (!sType[i]) { startS[s[i]]++; }
+    else { startL[s[i]+1]++; }
+  }
+  for (int c = 0; c <= upper; c++) {
+    startS[c] += startL[c];
+    if (c < upper) { startL[c+1] += startS[c]; }
+  }
 
-      stack<pair<int,int> > order;
-      while(ptr != root) {
-	order.push({ptr->inEdge->a, ptr->inEdge->b});
-	ptr = ptr->inEdge->begin;
-      }
-      while(!order.empty()){
-	pair<int,int> p = order.top();
-	order.pop();
-	for(int i = p.first; i <= p.second; i++){
-	  cur += str[i];
-	}
-      }
+  vector<int> bucket(upper+1);
+  auto induce = [&](const vector<int>& lms){
+    fill(sa.begin(), sa.end(), -1);
+    copy(startS.begin(), startS.end(), bucket.begin());
+    for (int i: lms) { sa[bucket[s[i]]++] = i; }
+
+    copy(startL.begin(), startL.end(), bucket.begin());
+    sa[bucket[s[n-1]]++] = n-1;
+    for (int i = 0; i < n; i++) {
+      int v = sa[i];
+      if (v >= 1 && !sType[v-1]) { sa[bucket[s[v-1]]++] = v-1; }
+    }
 
-      longest.push_back(cur);
+    copy(startL.begin(), startL.end(), bucket.begin());
+    for (int i = n-1; i >= 0; i--) {
+      int v = sa[i];
+      if (v >= 1 && sType[v-1]) { sa[--bucket[s[v-1]+1]] = v-1; }
     }
+  };
 
-    return length;
+  //leftmost S-type positions, and each one's index among them
+  vector<int> lms, lmsIndex(n,-1);
+  for (int i = 1; i < n; i++) {
+    if (!sType[i-1] && sType[i]) {
+      lmsIndex[i] = lms.size();
+      lms.push_back(i);
+    }
   }
-  
-};
+  int m = lms.size();
+
+  induce(lms);
+  if (m == 0) { return sa; }
+
+  vector<int> sorted;
+  sorted.reserve(m);
+  for (int v: sa) { if (lmsIndex[v] >= 0) { sorted.push_back(v); } }
+
+  //name LMS substrings; equal neighbours in sorted order share a name
+  vector<int> reduced(m);
+  int names = 0;
+  reduced[lmsIndex[sorted[0]]] = 0;
+  for (int i = 1; i < m; i++) {
+    int l = sorted[i-1], r = sorted[i];
+    int endL = lmsIndex[l]+1 < m ? lms[lmsIndex[l]+1] : n;
+    int endR = lmsIndex[r]+1 < m ? lms[lmsIndex[r]+1] : n;
+
+    bool same = endL-l == endR-r;
+    if (same) {
+      while (l < endL && s[l] == s[r]) { l++; r++; }
+      same = l < n && s[l] == s[r];
+    }
 
-ostream& operator<<(ostream& out, SuffixTree::Edge& e)
-{ return out << e.tree->str.substr(e.a,e.size()); }
+    if (!same) { names++; }
+    reduced[lmsIndex[sorted[i]]] = names;
+  }
 
-ostream& operator<<(ostream& out, SuffixTree::Node& n)
-{ return out << n.tree->str.substr(n.a,min(n.b,n.tree->last)-n.a+1); }	
+  vector<int> reducedSa = saIs(reduced.data(), m, names);
+  for (int i = 0; i < m; i++) { sorted[i] = lms[reducedSa[i]]; }
+  induce(sorted);
 
-ostream& operator<<(ostream& out, SuffixTree& t)
-{ return t.prettyFormat(out, t.root, 0); }
+  return sa;
+}
 
+struct SuffixArray {
 
-int main(int argc, char** argv) {
-  SuffixTree t(argv[1]);
-  cout << t << endl;
+  bool isDelim(char c) const {
+    return (c < LOWER) || (c > UPPER);
+  }
+
+  string str;
+  //sa[i] = start of the ith smallest suffix
+  //lcp[i] = longest common prefix of suffixes sa[i-1] and sa[i]; lcp[0] = 0
+  vector<int> sa, lcp;
 
-  /*
-  for(int i = 2; i < argc; i++){
-    printf("%s occurs %d times\n", argv[i], t.occurrences((string)argv[i]));
+  const string& getStr() const { return str; }
+
+  SuffixArray(const string& str) : str(str) {
+    int n = str.size();
+    sa = saIs((const unsigned char*)str.data(), n, 255);
+
+    //Kasai: going through suffixes in text order, the common prefix
+    //with the sorted predecessor shrinks by at most one each step
+    vector<int> rank(n);
+    for (int i = 0; i < n; i++) { rank[sa[i]] = i; }
+    lcp.assign(n,0);
+    int h = 0;
+    for (int i = 0; i < n; i++) {
+      if (rank[i] == 0) { h = 0; continue; }
+      int j = sa[rank[i]-1];
+      while (i+h < n && j+h < n && str[i+h] == str[j+h]) { h++; }
+      lcp[rank[i]] = h;
+      if (h) { h--; }
+    }
   }
-  */
 
+  //how many times s occurs across all input strings
+  //like SuffixTree, a match can end with a delimiter but not cross one
+  int occurrences(const string& s) const {
+    int m = s.size();
+    if (m == 0) { return 0; }
+    for (int i = 0; i+1 < m; i++) {
+      if (isDelim(s[i])) { return 0; }
+    }
+
+    //suffixes starting with s form one contiguous range of sa
+    auto first = [&](bool after){
+      int lo = 0, hi = sa.size();
+      while (lo < hi) {
+	int mid = (lo+hi)/2;
+	int c = str.compare(sa[mid], m, s);
+	if (c < 0 || (after && c == 0)) { lo = mid+1; }
+	else { hi = mid; }
+      }
+      return lo;
+    };
 
-  vector<string> longest;
-  int x = t.longestRepeat(longest,1);
-  cout << "The longest common substrings:" << endl;
-  for(auto s: longest) {
-    cout << '\t' << s << endl;
+    return first(true) - first(false);
   }
 
+  //same contract as SuffixTree::longestRepeat
+  //Each lcp-interval (a maximal range of sa sharing a prefix longer
+  //than its neighbours do) is an internal node of the suffix tree. The
+  //intervals come off a stack in one pass over lcp, while a Fenwick
+  //tree counts each input string only at its latest position so far,
+  //which gives how many distinct strings every interval spans.
+  int longestRepeat(vector<string>& longest, int threshold=0) const {
+    int n = str.size();
+
+    //input string each position belongs to (its delimiter included)
+    vector<int> doc(n);
+    int docs = 0;
+    for (int i = 0; i < n; i++) {
+      doc[i] = docs;
+      if (isDelim(str[i])) { docs++; }
+    }
 
-  return 0;
-}
+    vector<int> fenwick(n+1,0), latest(docs+1,-1);
+    auto add = [&](int i, int d){
+      for (i++; i <= n; i += i & -i) { fenwick[i] += d; }
+    };
+    auto prefix = [&](int i){
+      int total = 0;
+      for (; i > 0; i -= i & -i) { total += fenwick[i]; }
+      return total;
+    };
+
+    int length = 0;
+    vector<int> starts;
+
+    //open intervals as (depth, left end)
+    vector<pair<int,int> > open(1, {0,0});
+    for (int k = 1; k <= n; k++) {
+      int d = doc[sa[k-1]];
+      if (latest[d] >= 0) { add(latest[d], -1); }
+      add(k-1, 1);
+      latest[d] = k-1;
+
+      int h = k < n ? lcp[k] : 0;
+      int left = k-1;
+      while (h < open.back().first) {
+	int depth = open.back().first;
+	left = open.back().second;
+	open.pop_back();
+
+	//interval [left, k-1]
+	int distinct = prefix(k) - prefix(left);
+	if (distinct > threshold && depth >= length) {
+	  if (depth > length) {
+	    length = depth;
+	    starts.clear();
+	  }
+	  starts.push_back(sa[left]);
+	}
+      }
+      if (h > open.back().first) { open.push_back({h,left}); }
+    }
+
+    //SuffixTree reports them in lexicographic order
+    vector<string> found;
+    for (int i: starts) { found.push_back(str.substr(i,length)); }
+    sort(found.begin(), found.end());
+    longest.insert(longest.end(), found.begin(), found.end());
+
+    return length;
+  }
+
+};
@@ -0,0 +1,476 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <stack>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+#include "suffixTree.cpp"
+
+//With a text argument, prints its SuffixTree, how often each further
+//argument occurs, and the longest substrings repeated in 2+ inputs.
+//With "bench", builds SuffixTree, the pointer-based tree it replaced
+//and SuffixArray on the same generated text, each in its own process,
+//and reports build time, query time and peak RSS of each; all three
+//must give the same answers.
+//usage: suffixTreeBench text [pattern...]
+//       suffixTreeBench bench [chars]
+
+//The tree as it was before the index arena: a heap Node and Edge per
+//split and a map<char,Edge*> per node, kept for comparison
+namespace pointer {
+
+struct SuffixTree {
+
+  bool isDelim(char c){
+    return (c < LOWER) || (c > UPPER);
+  }
+
+  static const int INF = 1<<30;
+  int last;
+  string str;
+
+  struct Node;
+  struct Edge {
+    int a,b;
+    Node *begin,*end;
+    SuffixTree* tree;
+    Edge(int a, int b, Node *end, SuffixTree* tree)
+      : a(a), b(b), begin(NULL), end(end), tree(tree) {}
+    char getFirst() const { return tree->str[a]; }
+    int size() const { return min(tree->last,b)-a+1; }
+    friend ostream& operator<<(ostream& out, Edge& e);
+  };
+
+  struct Node {
+    Edge* inEdge;
+    map<char,Edge*> edges;
+    Node* suffix;
+    int a,b,leavesBelow,distinctDelims;
+    SuffixTree* tree;
+    Node(SuffixTree* tree)
+      : inEdge(NULL), leavesBelow(0), distinctDelims(0), tree(tree) {}
+
+    void add(Edge* e) { edges[e->getFirst()] = e; }
+    Edge* operator[](char c) { return edges[c]; }
+    int numChildren() { return edges.size(); }
+    friend ostream& operator<<(ostream& out, Node&);
+  };
+    
+  Node *root, *sentinel;
+
+  Node* getRoot() { return root; }
+  const string& getStr() const { return str; }
+  
+  void setPrefix(Node* n, Edge* e, int len) {
+    map<char,Edge*>::iterator it = n->edges.begin();
+    for (; it != n->edges.end(); ++it) {
+      Edge *edge = it->second;
+      setPrefix(edge->end,edge,len+min(edge->b,last)-edge->a+1);
+    }
+
+    if (e) {
+      n->b = min(e->b,last);
+      n->a = n->b - len + 1;
+    }
+
+    else {
+      n->a = 0;
+      n->b = -1;
+    }
+  }
+
+  Node* testAndSplit(Node* s, int k, int p, char c) {
+    if (k > p) {
+      return s == sentinel ? NULL : (*s)[c] == NULL ? s : NULL;
+    }
+
+    Edge* e = (*s)[str[k]];
+    if (c == str[e->a+p-k+1]) return NULL;
+    Node* r = new Node(this);
+    Edge* re = new Edge(e->a+p-k+1,e->b,e->end,this);
+    r->add(re);
+    Edge* se = new Edge(e->a,e->a+p-k,r,this);
+    s->add(se);
+    return r;
+  }
+
+  Node* canonize(Node* s, int& k, int p) {
+    if (p < k) { return s; }
+
+    if (s == sentinel) {
+      s = root;
+      ++k;
+      if (p < k) { return s; }
+    }
+
+    Edge* e = (*s)[str[k]];
+    while (e->b - e->a <= p - k) {
+      k = k + e->b - e->a + 1;
+      s = e->end;
+      if (k <= p) e = (*s)[str[k]];
+    }
+
+    return s;
+  }
+
+  Node* update(Node* s, int& k, int i) {
+    Node *oldr = root, *r = testAndSplit(s,k,i-1,str[i]);
+    while (r) {
+      Node* rp = new Node(this);
+      Edge* e = new Edge(i,INF,rp,this);
+      r->add(e);
+      if (oldr != root) { oldr->suffix = r; }
+      oldr = r;
+      s = canonize(s->suffix,k,i-1);
+      r = testAndSplit(s,k,i-1,str[i]);	    
+    }
+
+    if (oldr != root) { oldr->suffix = s; }
+
+    return s;
+  }
+
+  void buildTree() {
+    root = new Node(this);
+    sentinel = new Node(this);
+    root->suffix = sentinel;
+    Node* s = root;
+    int k = 0;
+    last = -1;
+    for (int i = 0; i < (int)str.size(); ++i) {
+      ++last;
+      s = update(s,k,i);
+      s = canonize(s,k,i);
+    }
+  }
+
+  int fix(int x) const { return x == INF ? last : x; }
+
+  friend ostream& operator<<(ostream& out, SuffixTree& t);
+
+  ostream& prettyFormat(ostream& out, Node* n, int tab) const {
+    out << string(tab,' ') << "\"" << *n << "\"" << n->distinctDelims << endl;
+    map<char,Edge*>::iterator it = n->edges.begin();
+
+    for (; it != n->edges.end(); ++it) {
+      Edge* e = it->second;
+
+      out << string(tab,' ') << it->first << " : "
+	   << *e << " = " << e->a << ',' << fix(e->b) << ',' << e->size() << endl;
+
+      prettyFormat(out,e->end,tab+2);
+    }
+
+    return out;
+  }
+
+  //number of leaves in subtree
+  //number of distinct delimiters
+  int postprocess(Node* n, set<char>& delims) {
+    for(auto p: n->edges){
+      //assign parent pointers
+      Edge* e = p.second;
+      Node* child = e->end;
+
+      child->inEdge = e;
+      e->begin = n;
+
+      //count number of leaves in subtree
+      set<char> childDelims;
+      n->leavesBelow += postprocess(child, childDelims);
+      for(auto c: childDelims) { delims.insert(c); }
+      
+    }
+
+    //leaf
+    if (n->numChildren() == 0) {
+      n->leavesBelow = 1;
+      
+      Edge* inEdge = n->inEdge;
+
+      for(int i = 0; i < inEdge->size(); i++){
+	if (isDelim(str[inEdge->a + i])) {
+	  inEdge->b = inEdge->a + i;
+	  n->b = inEdge->b;
+	  break;
+	}
+      }
+
+      int index = inEdge->a + inEdge->size() - 1;
+      delims.insert(str[index]);
+    }
+
+    n->distinctDelims = delims.size();
+
+    return n->leavesBelow;
+  }
+
+  SuffixTree(const string& str) : str(str) {
+    buildTree();
+    setPrefix(root,NULL,0);
+    set<char> delims;
+    postprocess(root,delims);
+  }
+
+  void destroyNode(Node* n){
+    for(auto p: n->edges){
+      Edge* e = p.second;
+      destroyNode(e->end);
+      delete e;
+    }
+
+    delete n;
+  }
+
+  ~SuffixTree(){
+    destroyNode(root);
+    delete sentinel;
+  }
+
+  int occurrences(const string& s, int index, Node* n){
+    //cerr << "Called occurrences()" << endl;
+    if (n->numChildren() == 0) {
+      //cerr << "No children" << endl;
+      return 0;
+    }
+    if (n->edges.find(s[index]) == n->edges.end()) {
+      //cerr << "Cannot find " << s[index] << endl;
+      return 0;
+    }
+
+    Edge* e = n->edges[s[index]];
+
+    for(int i = e->a; i < e->a+e->size(); i++){
+
+      if (str[i] == s[index]) {
+	index++;
+	if (index == (int)s.size()) { break; }
+      }
+
+      else { return 0; }
+    }
+
+    if (index == (int)s.size()) { return max(1,e->end->leavesBelow); }
+
+    return occurrences(s,index,e->end);
+  }
+
+  int occurrences(const string& s){
+    return occurrences(s,0,root);
+  }
+  
+  void longestRepeat(Node* n, int size, int& length,
+		     vector<Node*>& ptrs, int threshold){
+    if (n != root
+	//repeats iff there are multiple leaves in the subtree
+	&& n->leavesBelow > 1
+	//longest
+	&& size >= length
+	//check if the number of input strings is above the specified threshold
+	&& n->distinctDelims > threshold
+	) {
+      if (size > length) {
+	length = size;
+	ptrs.clear();
+      }
+      ptrs.push_back(n);
+      
+    }
+
+    for(auto p: n->edges){
+      Edge* e = p.second;
+      longestRepeat(e->end, size+e->size(), length, ptrs, threshold);
+    }
+
+  }
+
+  int longestRepeat(vector<string>& longest, int threshold=0){
+    int length = 0;
+    vector<Node*> ptrs;
+
+    longestRepeat(root, 0, length, ptrs, threshold);
+
+    //reconstruct by walking up to root
+    for (auto p: ptrs) {
+      Node* ptr = p;
+      string cur = "";
+
+      stack<pair<int,int> > order;
+      while(ptr != root) {
+	order.push({ptr->inEdge->a, ptr->inEdge->b});
+	ptr = ptr->inEdge->begin;
+      }
+      while(!order.empty()){
+	pair<int,int> p = order.top();
+	order.pop();
+	for(int i = p.first; i <= p.second; i++){
+	  cur += str[i];
+	}
+      }
+
+      longest.push_back(cur);
+    }
+
+    return length;
+  }
+  
+};
+
+ostream& operator<<(ostream& out, SuffixTree::Edge& e)
+{ return out << e.tree->str.substr(e.a,e.size()); }
+
+ostream& operator<<(ostream& out, SuffixTree::Node& n)
+{ return out << n.tree->str.substr(n.a,min(n.b,n.tree->last)-n.a+1); }	
+
+ostream& operator<<(ostream& out, SuffixTree& t)
+{ return t.prettyFormat(out, t.root, 0); }
+
+}
+
+//docs inputs of random letters from the first sigma, each terminated
+//by its own delimiter; chars in total
+string generatedText(size_t chars, int docs, int sigma, mt19937& rng){
+  string text;
+  text.reserve(chars);
+  for(int d = 0; d < docs; d++){
+    size_t len = chars/docs - 1;
+    for(size_t i = 0; i < len; i++) { text += (char)(LOWER + rng()%sigma); }
+    text += ithDelim(d);
+  }
+  return text;
+}
+
+struct BenchResult {
+  double build, query;
+  long peakKB;
+  long long occurrenceSum;
+  int repeatLength, repeats;
+};
+
+//builds a Tree on text in a child process and runs every query on it,
+//so that ru_maxrss measures this structure alone
+template <typename Tree>
+bool measure(const string& text, const vector<string>& queries,
+	     BenchResult& r){
+  int fds[2];
+  if (pipe(fds) != 0) { return false; }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+
+    auto start = chrono::steady_clock::now();
+    Tree* t = new Tree(text);
+    chrono::duration<double> build = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    long long sum = 0;
+    for(auto& q: queries) { sum += t->occurrences(q); }
+    chrono::duration<double> query = chrono::steady_clock::now() - start;
+
+    vector<string> longest;
+    int length = t->longestRepeat(longest, 1);
+    getrusage(RUSAGE_SELF, &after);
+
+    BenchResult out = {build.count(), query.count(),
+		       after.ru_maxrss - before.ru_maxrss, sum, length,
+		       (int)longest.size()};
+    ssize_t written = write(fds[1], &out, sizeof(out));
+    _exit(written == sizeof(out) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  ssize_t got = pid > 0 ? read(fds[0], &r, sizeof(r)) : -1;
+  close(fds[0]);
+  int status = 0;
+  if (pid > 0) { waitpid(pid, &status, 0); }
+  return got == sizeof(r) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int benchmark(size_t chars){
+  mt19937 rng(25);
+  string text = generatedText(chars, 16, 4, rng);
+
+  //half substrings of the text, half random strings over the same letters
+  vector<string> queries(200000);
+  for(auto& q: queries){
+    size_t len = 4 + rng()%12;
+    if (rng()%2) {
+      q = text.substr(rng()%(text.size() - len), len);
+      //a match can end with a delimiter but not cross one
+      for(size_t i = 0; i+1 < q.size(); i++){
+	if (q[i] < LOWER || q[i] > UPPER) { q[i] = LOWER; }
+      }
+    }
+    else {
+      q.resize(len);
+      for(auto& ch: q) { ch = LOWER + rng()%4; }
+    }
+  }
+
+  printf("%zu chars in 16 inputs over 4 letters, %zu queries\n",
+	 text.size(), queries.size());
+
+  vector<pair<const char*, BenchResult> > results(3);
+  bool ok = measure<SuffixTree>(text, queries, results[0].second) &&
+    measure<pointer::SuffixTree>(text, queries, results[1].second) &&
+    measure<SuffixArray>(text, queries, results[2].second);
+  results[0].first = "SuffixTree (arena)";
+  results[1].first = "SuffixTree (pointers)";
+  results[2].first = "SuffixArray";
+  if (!ok) {
+    printf("a child process failed\n");
+    return 1;
+  }
+
+  int failures = 0;
+  for(auto& r: results){
+    BenchResult& x = r.second;
+    BenchResult& y = results[0].second;
+    bool same = x.occurrenceSum == y.occurrenceSum &&
+      x.repeatLength == y.repeatLength && x.repeats == y.repeats;
+    if (!same) { failures++; }
+    printf("  %-22s build %.3fs  queries %.3fs  peak RSS %ld MB%s\n", r.first,
+	   x.build, x.query, x.peakKB >> 10, same ? "" : "  MISMATCH");
+  }
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: %s text [pattern...]\n       %s bench [chars]\n",
+	   argv[0], argv[0]);
+    return 1;
+  }
+  if (strcmp(argv[1], "bench") == 0) {
+    return benchmark(argc > 2 ? atol(argv[2]) : 1000000) ? 1 : 0;
+  }
+
+  SuffixTree t(argv[1]);
+  cout << t << endl;
+
+  for(int i = 2; i < argc; i++){
+    printf("%s occurs %d times\n", argv[i], t.occurrences((string)argv[i]));
+  }
+
+  vector<string> longest;
+  int length = t.longestRepeat(longest,1);
+  cout << "The longest common substrings (length " << length << "):" << endl;
+  for(auto s: longest) {
+    cout << '\t' << s << endl;
+  }
+
+  return 0;
+}
@@ -1,6 +1,10 @@
 //returns if adj describes a DAG
-bool kahn(AdjacencyList& adj, queue<int>& noPreReq, vi& degree,
+//appends the order to sequence (anything already in it is kept)
+//Graph is an AdjacencyList or a CSRGraph
+template <typename Graph>
+bool kahn(Graph& adj, queue<int>& noPreReq, vi& degree,
 	  vi& sequence){
+  size_t before = sequence.size();
   while(!noPreReq.empty()){
     int u = noPreReq.front();
     noPreReq.pop();
@@ -10,13 +14,197 @@ bool kahn(AdjacencyList& adj, queue<int>& noPreReq, vi& degree,
     for(auto p: adj[u]){
       int v = p.first;
       degree[v]--;
-      if (degree[v] < 0) { return false; }
-      else if (degree[v] == 0) {
+      if (degree[v] == 0) {
 	noPreReq.push(v);
       }
       
     }
   }
 
-  return true;
+  //nodes on or behind a cycle never reach degree 0
+  return sequence.size() - before == adj.size();
 }
+
+//Wavefront topological sort
+//Computes indegrees itself, then peels every zero-indegree node at
+//once: levels[k] holds the nodes whose longest path from a source has
+//k edges, so all of a level can run concurrently once the levels
+//before it are done. Each level is sorted, so output is deterministic.
+//Big waves are split across the pool with atomic decrements; small
+//ones run inline, so long chains don't pay for a wake-up per level.
+//returns if adj describes a DAG; if not, levels holds everything
+//that doesn't depend on a cycle
+template <typename Graph>
+bool topoLevels(Graph& adj, vector<vi>& levels, ThreadPool& pool,
+		size_t smallWave = 1024){
+  int n = adj.size();
+  int threads = pool.size();
+  levels.clear();
+
+  vector<atomic<int> > indeg(n);
+  for(auto& d: indeg) { d.store(0, memory_order_relaxed); }
+
+  auto blocks = [&](size_t m, function<void(size_t,size_t,int)> f){
+    if (m <= smallWave || threads == 1) { f(0,m,0); return; }
+    pool.runAll([&](int t){ f(m*t/threads, m*(t+1)/threads, t); });
+  };
+
+  blocks(n, [&](size_t lo, size_t hi, int){
+      for(size_t u = lo; u < hi; u++){
+	for(auto p: adj[u]) { indeg[p.first].fetch_add(1, memory_order_relaxed); }
+      }
+    });
+
+  vector<vi> found(threads);
+  blocks(n, [&](size_t lo, size_t hi, int t){
+      for(size_t u = lo; u < hi; u++){
+	if (indeg[u].load(memory_order_relaxed) == 0) { found[t].push_back(u); }
+      }
+    });
+
+  size_t done = 0;
+  while(true){
+    vi wave;
+    for(auto& f: found){
+      wave.insert(wave.end(), f.begin(), f.end());
+      f.clear();
+    }
+    if (wave.empty()) { break; }
+
+    sort(wave.begin(), wave.end());
+    done += wave.size();
+    levels.push_back(move(wave));
+    const vi& cur = levels.back();
+
+    //whoever takes v's last prerequisite owns v
+    blocks(cur.size(), [&](size_t lo, size_t hi, int t){
+	for(size_t i = lo; i < hi; i++){
+	  for(auto p: adj[cur[i]]){
+	    if (indeg[p.first].fetch_sub(1, memory_order_acq_rel) == 1)
+	      { found[t].push_back(p.first); }
+	  }
+	}
+      });
+  }
+
+  return done == (size_t)n;
+}
+
+//threads = 0 uses every core
+template <typename Graph>
+bool topoLevels(Graph& adj, vector<vi>& levels, int threads = 0){
+  ThreadPool pool(threads);
+  return topoLevels(adj, levels, pool);
+}
+
+//flattens levels into one order, as kahn() would return it
+template <typename Graph>
+bool parallelTopoSort(Graph& adj, vi& sequence, int threads = 0){
+  vector<vi> levels;
+  bool dag = topoLevels(adj, levels, threads);
+  for(auto& l: levels) { sequence.insert(sequence.end(), l.begin(), l.end()); }
+  return dag;
+}
+
+//Topological order kept up to date as edges arrive (Pearce-Kelly)
+//Inserting u->v with u already before v costs nothing. Otherwise only
+//the nodes ordered between v and u are searched: those reachable from
+//v and those reaching u swap into the slots they occupied, so the
+//rest of the order never moves. An edge that would close a cycle is
+//rejected and the graph is left unchanged.
+class DynamicTopoOrder{
+
+private:
+  vector<vi> out, in;
+  //ord[v] = position of v; seq[i] = node at position i
+  vi ord, seq;
+  vector<char> visited;
+  vi stk, fwd, bwd;
+
+  //collects into found every node reachable from start in g that is
+  //positioned in [lo,hi]; returns false if it reaches stop
+  bool search(const vector<vi>& g, int start, int lo, int hi,
+	      int stop, vi& found){
+    visited[start] = 1;
+    found.push_back(start);
+    stk.assign(1,start);
+    while(!stk.empty()){
+      int x = stk.back();
+      stk.pop_back();
+      for(int y: g[x]){
+	if (y == stop) { return false; }
+	if (visited[y] || ord[y] < lo || ord[y] > hi) { continue; }
+	visited[y] = 1;
+	found.push_back(y);
+	stk.push_back(y);
+      }
+    }
+    return true;
+  }
+
+public:
+  //n nodes, no edges, ordered 0..n-1
+  DynamicTopoOrder(int n = 0) : out(n), in(n), ord(n), seq(n), visited(n,0) {
+    for(int v = 0; v < n; v++) { ord[v] = seq[v] = v; }
+  }
+
+  //adds a node with no edges at the end of the order; returns its id
+  int addNode(){
+    int v = ord.size();
+    out.push_back(vi());
+    in.push_back(vi());
+    ord.push_back(v);
+    seq.push_back(v);
+    visited.push_back(0);
+    return v;
+  }
+
+  //returns false, and leaves everything as it was, if u->v would
+  //close a cycle
+  bool addEdge(int u, int v){
+    if (u == v) { return false; }
+
+    if (ord[u] > ord[v]) {
+      int lb = ord[v], ub = ord[u];
+      fwd.clear();
+      bwd.clear();
+
+      bool acyclic = search(out, v, lb, ub, u, fwd);
+      if (acyclic) { search(in, u, lb, ub, -1, bwd); }
+      for(int x: fwd) { visited[x] = 0; }
+      for(int x: bwd) { visited[x] = 0; }
+      if (!acyclic) { return false; }
+
+      //everything that reaches u goes first, then everything v reaches,
+      //each keeping its relative order, in the slots they already held
+      auto byOrd = [&](int a, int b){ return ord[a] < ord[b]; };
+      sort(fwd.begin(), fwd.end(), byOrd);
+      sort(bwd.begin(), bwd.end(), byOrd);
+
+      vi slots;
+      for(int x: bwd) { slots.push_back(ord[x]); }
+      for(int x: fwd) { slots.push_back(ord[x]); }
+      sort(slots.begin(), slots.end());
+
+      size_t i = 0;
+      for(int x: bwd) { ord[x] = slots[i++]; }
+      for(int x: fwd) { ord[x] = slots[i++]; }
+      for(size_t j = 0; j < slots.size(); j++) { seq[slots[j]] = -1; }
+      for(int x: bwd) { seq[ord[x]] = x; }
+      for(int x: fwd) { seq[ord[x]] = x; }
+    }
+
+    out[u].push_back(v);
+    in[v].push_back(u);
+    return true;
+  }
+
+  size_t size() const { return ord.size(); }
+
+  //position of v in the current order
+  int position(int v) const { return ord[v]; }
+
+  //the current order, as kahn() fills sequence
+  const vi& sequence() const { return seq; }
+
+};